@@ -0,0 +1,70 @@
+#include "bench.h"
+#include <algorithm>
+#include <stdio.h>
+
+#define BENCH_CALIBRATION_ITERATIONS 200
+
+static void empty_bench(void *) {}
+
+Bench_Runner::Bench_Runner(Bench_Clock clock, uint32_t *sample_buffer) {
+    this->clock = clock;
+    samples = sample_buffer;
+    overhead = 0;
+}
+
+void Bench_Runner::calibrate() {
+    overhead = 0;
+    Bench_Case empty = {"empty", empty_bench, nullptr, 20, BENCH_CALIBRATION_ITERATIONS};
+    overhead = run(empty).min;
+}
+
+Bench_Result Bench_Runner::run(const Bench_Case& bench) {
+    // volatile so the call can't be inlined into the timing loop
+    Bench_Fn volatile fn = bench.fn;
+    uint32_t iterations = bench.iterations < BENCH_MAX_SAMPLES ? bench.iterations : BENCH_MAX_SAMPLES;
+    if (iterations == 0) iterations = 1;
+
+    for (uint32_t i = 0; i < bench.warmup; i++) fn(bench.ctx);
+    if (bench.failures) *bench.failures = 0;
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t start = clock();
+        fn(bench.ctx);
+        uint32_t elapsed = clock() - start;
+        elapsed = elapsed > overhead ? elapsed - overhead : 0;
+        samples[i] = elapsed;
+        total += elapsed;
+    }
+
+    std::sort(samples, samples + iterations);
+    // nearest-rank percentile
+    auto percentile = [&](uint32_t p) { return samples[(iterations * p + 99) / 100 - 1]; };
+
+    Bench_Result result;
+    result.name = bench.name;
+    result.iterations = iterations;
+    result.min = samples[0];
+    result.p50 = percentile(50);
+    result.p90 = percentile(90);
+    result.p99 = percentile(99);
+    result.max = samples[iterations - 1];
+    result.mean = (uint32_t)(total / iterations);
+    result.counts_failures = bench.failures != nullptr;
+    result.failures = bench.failures ? *bench.failures : 0;
+    return result;
+}
+
+void format_result(const Bench_Result& r, char *line, size_t size) {
+    int len = snprintf(line, size,
+                       "{\"type\":\"bench\",\"name\":\"%s\",\"iters\":%lu,\"min\":%lu,\"p50\":%lu,"
+                       "\"p90\":%lu,\"p99\":%lu,\"max\":%lu,\"mean\":%lu",
+                       r.name, (unsigned long)r.iterations, (unsigned long)r.min, (unsigned long)r.p50,
+                       (unsigned long)r.p90, (unsigned long)r.p99, (unsigned long)r.max, (unsigned long)r.mean);
+    if (len < 0 || (size_t)len >= size) return;
+    if (r.counts_failures) {
+        snprintf(line + len, size - len, ",\"failures\":%lu}", (unsigned long)r.failures);
+    } else {
+        snprintf(line + len, size - len, "}");
+    }
+}
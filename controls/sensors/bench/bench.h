@@ -0,0 +1,76 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Microbenchmark harness shared by the on-target (bench, bench_teensy31) and
+host (bench_native) environments.
+
+Every iteration is timed on its own with the platform's tick source (DWT
+cycle counter on the Teensy, steady_clock ns on the host). The cost of an
+empty call is measured first and subtracted. Results are printed as one JSON
+object per line, so runs can be diffed between commits and boards:
+
+    {"type":"env","board":"teensy41","rev":"4f29ef1","tick_hz":600000000,...}
+    {"type":"bench","name":"fixed_mul_q16","iters":1000,"min":..,"p50":..,"p90":..,"p99":..,"max":..,"mean":..}
+
+Driver benches that can fail (I2C errors, unacked radio frames) add a
+"failures" count instead of printing anything, so the stream stays JSON.
+
+All timings are in ticks; divide by tick_hz from the env line for seconds.
+*/
+
+#define BENCH_MAX_SAMPLES 1000
+#define BENCH_LINE_SIZE 256
+
+#ifndef BENCH_GIT_REV
+#define BENCH_GIT_REV "unknown"
+#endif
+
+typedef void (*Bench_Fn)(void *ctx);
+typedef uint32_t (*Bench_Clock)();
+
+struct Bench_Case {
+    const char *name;
+    Bench_Fn fn;
+    void *ctx;
+    uint32_t warmup;
+    uint32_t iterations; // capped at BENCH_MAX_SAMPLES
+    uint32_t *failures;  // optional: the bench counts failed calls here, reported as "failures"
+};
+
+struct Bench_Result {
+    const char *name;
+    uint32_t iterations;
+    uint32_t min, p50, p90, p99, max;
+    uint32_t mean;
+    bool counts_failures;
+    uint32_t failures; // during the timed iterations
+};
+
+class Bench_Runner {
+public:
+    Bench_Runner(Bench_Clock clock, uint32_t *sample_buffer);
+
+    // times an empty call, subtracted from every sample afterwards
+    void calibrate();
+    Bench_Result run(const Bench_Case& bench);
+    uint32_t get_overhead() const { return overhead; }
+
+private:
+    Bench_Clock clock;
+    uint32_t *samples;
+    uint32_t overhead;
+};
+
+// one JSON line, without the trailing newline
+void format_result(const Bench_Result& result, char *line, size_t size);
+
+// Benchmarks of pure computation (fixed point, servo mapping, telemetry
+// packing, parsers), built for the target and the host alike.
+extern const Bench_Case compute_benches[];
+extern const size_t num_compute_benches;
+
+#endif
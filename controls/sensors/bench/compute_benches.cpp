@@ -0,0 +1,189 @@
+#include <Arduino.h>
+#include "bench.h"
+#include "config.h"
+#include "math/numeric.h"
+#include "motors/servo_drivers.h"
+#include "datalog/telemetry_mux.h"
+#include "datalog/command_link.h"
+#include "sensors/tfmini_parser.h"
+#include "sensors/bmp388_compensation.h"
+
+#define MATH_CHAIN_LENGTH 16
+
+// results land here so the compiler can't drop the work
+static volatile float float_sink;
+static volatile int32_t int_sink;
+
+// ---- fixed point vs float ----
+
+template <typename Real>
+struct Math_Ctx {
+    Real a, b, acc;
+};
+
+template <typename Real>
+static void mul_add_chain(void *ctx) {
+    Math_Ctx<Real> *m = (Math_Ctx<Real> *)ctx;
+    Real acc = m->acc;
+    for (int i = 0; i < MATH_CHAIN_LENGTH; i++) acc = acc * m->a + m->b;
+    int_sink = num::to_int(acc);
+}
+
+static Math_Ctx<float> float_math = {0.999f, 0.001f, 1.0f};
+static Math_Ctx<q16_16> q16_math = {q16_16(0.999), q16_16(0.001), q16_16(1.0)};
+
+// ---- servo mapping ----
+
+template <typename Real>
+struct Gimbal_Ctx {
+    Gimbal_T<Real> gimbal;
+    Real angle;
+    Real step;
+};
+
+// set_angles is the pure mapping/clipping part; drive_servos (PWM output) is benched on target
+template <typename Real>
+static void gimbal_set_angles(void *ctx) {
+    Gimbal_Ctx<Real> *g = (Gimbal_Ctx<Real> *)ctx;
+    g->angle = g->angle + g->step;
+    if (g->angle > Real(0.2)) g->angle = Real(-0.2);
+    g->gimbal.set_angles(g->angle, -g->angle);
+}
+
+static Gimbal_Ctx<float> gimbal_float = {Gimbal_T<float>(SERVO_PIN_Y, SERVO_PIN_Z), 0.0f, 0.001f};
+static Gimbal_Ctx<q16_16> gimbal_q16 = {Gimbal_T<q16_16>(SERVO_PIN_Y, SERVO_PIN_Z), q16_16(0.0), q16_16(0.001)};
+
+// ---- barometer compensation and altitude, float vs the integer teensy31 path ----
+
+// plausible trimming bytes; the benches only need realistic magnitudes
+static const uint8_t baro_calib[BMP388_CALIB_SIZE] = {
+    0x55, 0x6C, 0xD1, 0x4A, 0xF9, 0x07, 0x06, 0x3C, 0xF6, 0x04, 0x00,
+    0xC0, 0x5D, 0x60, 0x6D, 0x03, 0xFA, 0x80, 0x3E, 0x04, 0xC4,
+};
+
+struct Baro_Ctx {
+    BMP388_Compensation comp;
+    uint32_t raw_pressure, raw_temperature;
+    bool configured;
+};
+
+static Baro_Ctx baro_ctx = {BMP388_Compensation(), 6500000, 8400000, false};
+
+static void baro_compensate_float(void *ctx) {
+    Baro_Ctx *b = (Baro_Ctx *)ctx;
+    if (!b->configured) {
+        b->comp.set_calibration(baro_calib);
+        b->configured = true;
+    }
+    float t = b->comp.temperature_float(b->raw_temperature);
+    float p = b->comp.pressure_float(b->raw_pressure, t);
+    float_sink = BMP388_Compensation::altitude_float(p, SEA_LEVEL_PRESSURE_HPA);
+}
+
+static void baro_compensate_int(void *ctx) {
+    Baro_Ctx *b = (Baro_Ctx *)ctx;
+    if (!b->configured) {
+        b->comp.set_calibration(baro_calib);
+        b->configured = true;
+    }
+    int64_t t_lin;
+    b->comp.temperature_int(b->raw_temperature, t_lin);
+    uint32_t p = b->comp.pressure_int(b->raw_pressure, t_lin);
+    int_sink = BMP388_Compensation::altitude_mm(p, (uint32_t)(SEA_LEVEL_PRESSURE_HPA * 10000.0 + 0.5));
+}
+
+// ---- telemetry packing ----
+
+static void fill_zeros(uint8_t *buf, void *ctx) {
+    memset(buf, 0, (size_t)ctx);
+}
+
+struct Mux_Ctx {
+    Telemetry_Mux mux;
+    uint32_t now_us;
+    bool configured;
+};
+
+static Mux_Ctx mux_ctx = {Telemetry_Mux(1000000), 0, false};
+
+// attitude + gps + temperature + status, stepped 20 ms so the 50 Hz channel is always due
+static void telemetry_build_frame(void *ctx) {
+    Mux_Ctx *m = (Mux_Ctx *)ctx;
+    if (!m->configured) {
+        m->mux.add_channel(1, 16, 0, 50, fill_zeros, (void *)16);
+        m->mux.add_channel(2, 8, 1, 5, fill_zeros, (void *)8);
+        m->mux.add_channel(3, 2, 2, 1, fill_zeros, (void *)2);
+        m->mux.add_channel(4, 1, 0, 0, fill_zeros, (void *)1);
+        m->configured = true;
+    }
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    m->now_us += 20000;
+    int_sink = m->mux.build_frame(m->now_us, frame);
+    m->mux.report_result(true, 0);
+}
+
+// ---- parsers ----
+
+struct Parser_Ctx {
+    TFMini_Frame_Parser parser;
+    uint8_t stream[64];
+    bool filled;
+};
+
+static Parser_Ctx parser_ctx;
+
+// 64 bytes = 7 frames and a partial one, the size of one UART drain chunk
+static void tfmini_parse_chunk(void *ctx) {
+    Parser_Ctx *p = (Parser_Ctx *)ctx;
+    if (!p->filled) {
+        for (size_t i = 0; i < sizeof(p->stream); i++) {
+            size_t k = i % TFMINI_FRAME_SIZE;
+            p->stream[i] = k < 2 ? TFMINI_HEADER : (uint8_t)i;
+            if (k == TFMINI_FRAME_SIZE - 1) {
+                uint8_t sum = 0;
+                for (size_t j = i - k; j < i; j++) sum += p->stream[j];
+                p->stream[i] = sum;
+            }
+        }
+        p->filled = true;
+    }
+    TFMini_Frame frames[8];
+    int_sink = (int32_t)p->parser.parse(p->stream, sizeof(p->stream), frames, 8);
+}
+
+struct Command_Ctx {
+    uint8_t frame[32];
+    uint8_t len;
+};
+
+static Command_Ctx command_ctx;
+
+// largest command: CRC over the whole 31-byte frame
+static void command_decode(void *ctx) {
+    Command_Ctx *c = (Command_Ctx *)ctx;
+    if (c->len == 0) {
+        Command cmd;
+        cmd.session = 1;
+        cmd.seq = 1;
+        cmd.opcode = COMMAND_SET_GAINS;
+        cmd.arg_len = COMMAND_MAX_ARGS;
+        memset(cmd.args, 0x5A, sizeof(cmd.args));
+        c->len = encode_command(cmd, c->frame);
+    }
+    Command out;
+    int_sink = decode_command(c->frame, c->len, out);
+}
+
+const Bench_Case compute_benches[] = {
+    {"float_mul_add_x16", mul_add_chain<float>, &float_math, 100, 1000},
+    {"q16_16_mul_add_x16", mul_add_chain<q16_16>, &q16_math, 100, 1000},
+    {"gimbal_set_angles_float", gimbal_set_angles<float>, &gimbal_float, 100, 1000},
+    {"gimbal_set_angles_q16_16", gimbal_set_angles<q16_16>, &gimbal_q16, 100, 1000},
+    {"baro_compensate_float", baro_compensate_float, &baro_ctx, 100, 1000},
+    {"baro_compensate_int", baro_compensate_int, &baro_ctx, 100, 1000},
+    {"telemetry_build_frame", telemetry_build_frame, &mux_ctx, 100, 1000},
+    {"tfmini_parse_64_bytes", tfmini_parse_chunk, &parser_ctx, 100, 1000},
+    {"command_decode_max", command_decode, &command_ctx, 100, 1000},
+};
+
+const size_t num_compute_benches = sizeof(compute_benches) / sizeof(compute_benches[0]);
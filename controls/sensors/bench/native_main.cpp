@@ -0,0 +1,29 @@
+// Host build of the compute benchmarks, no hardware needed:
+//     pio run -e bench_native -t exec > bench_native.jsonl
+
+#include "bench.h"
+#include <chrono>
+#include <stdio.h>
+
+static uint32_t clock_ns() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t samples[BENCH_MAX_SAMPLES];
+
+int main() {
+    Bench_Runner runner(clock_ns, samples);
+    runner.calibrate();
+
+    printf("{\"type\":\"env\",\"board\":\"native\",\"rev\":\"%s\",\"tick_hz\":1000000000,"
+           "\"overhead_ticks\":%lu}\n",
+           BENCH_GIT_REV, (unsigned long)runner.get_overhead());
+
+    char line[BENCH_LINE_SIZE];
+    for (size_t i = 0; i < num_compute_benches; i++) {
+        format_result(runner.run(compute_benches[i]), line, sizeof(line));
+        puts(line);
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// On-target benchmarks of the drivers and the compute routines, timed with the
+// DWT cycle counter. Replaces src/main.cpp in the bench environments:
+//     pio run -e bench -t upload && pio device monitor > bench_teensy41.jsonl
+//     pio run -e bench_teensy31 -t upload && pio device monitor > bench_teensy31.jsonl
+// Needs the flight hardware attached; a missing IMU or barometer stops in its setup().
+// The driver setup messages come first, every line from the env line on is JSON.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <RF24.h>
+#include "config.h"
+#include "bench.h"
+#include "sensors/imu.h"
+#include "sensors/barometer.h"
+#include "sensors/gps.h"
+#include "sensors/lidar.h"
+#include "motors/servo_drivers.h"
+#include "datalog/transceiver.h"
+#include "util/cycle_counter.h"
+#include "util/memory_placement.h"
+
+#define BENCH_I2C_HZ 100000 // Wire default, what the flight code runs at
+#define BENCH_GPS_BAUD 9600
+#define BENCH_DRIVER_WARMUP 10
+#define BENCH_DRIVER_ITERATIONS 200
+
+#if defined(__IMXRT1062__)
+#define BENCH_BOARD "teensy41"
+#define BENCH_F_BUS F_BUS_ACTUAL
+#else
+#define BENCH_BOARD "teensy31"
+#define BENCH_F_BUS F_BUS
+#endif
+
+// servo PWM on the radio's CE/CSN lines would corrupt both benches
+static_assert(SERVO_PIN_Y != CE_PIN && SERVO_PIN_Y != CSN_PIN && SERVO_PIN_Z != CE_PIN && SERVO_PIN_Z != CSN_PIN,
+              "servo pins overlap the nRF24 CE/CSN pins");
+
+// what RF24 asks SPI for; the bus runs at the fastest divider at or below it
+#ifndef RF24_SPI_SPEED
+#define RF24_SPI_SPEED 10000000
+#endif
+
+BNO055_IMU bno(BNO055_I2C_ADDRESS, BNO055_WIRE);
+BMP388_Barometer bmp(BMP388_I2C_ADDRESS, BMP388_WIRE);
+GPS gps(Serial1, BENCH_GPS_BAUD);
+TFMiniS lidar(TFMINI_SERIAL, TFMINI_BAUD_RATE);
+Gimbal gimbal(SERVO_PIN_Y, SERVO_PIN_Z);
+Telemetry telemetry;
+
+static uint32_t samples[BENCH_MAX_SAMPLES] TVC_DMAMEM;
+
+static volatile float sink;
+
+static void imu_get_quaternion(void *) { sink = bno.getQuaternion().w(); }
+// read_altitude, not getAltitude: that one prints on an I2C failure and would break the JSONL
+static uint32_t baro_failures;
+static void baro_read_altitude(void *) {
+    float altitude;
+    if (!bmp.read_altitude(altitude)) {
+        baro_failures++;
+        return;
+    }
+    sink = altitude;
+}
+static void gps_update(void *) { gps.update(); }
+static void lidar_update(void *) { sink = lidar.update(); }
+static uint32_t telemetry_failures;
+static void send_telemetry(void *) {
+    if (!sendTelemetry(telemetry)) telemetry_failures++;
+}
+
+static void gimbal_drive_servos(void *) {
+    static real_t angle = real_t(0.0);
+    angle = angle > real_t(0.2) ? real_t(-0.2) : angle + real_t(0.01);
+    gimbal.drive_servos(angle, -angle);
+}
+
+static const Bench_Case driver_benches[] = {
+    {"imu_get_quaternion", imu_get_quaternion, nullptr, BENCH_DRIVER_WARMUP, BENCH_DRIVER_ITERATIONS},
+    {"baro_read_altitude", baro_read_altitude, nullptr, BENCH_DRIVER_WARMUP, BENCH_DRIVER_ITERATIONS, &baro_failures},
+    {"gps_update", gps_update, nullptr, BENCH_DRIVER_WARMUP, BENCH_DRIVER_ITERATIONS},
+    {"lidar_update", lidar_update, nullptr, BENCH_DRIVER_WARMUP, BENCH_DRIVER_ITERATIONS},
+    {"gimbal_drive_servos", gimbal_drive_servos, nullptr, BENCH_DRIVER_WARMUP, BENCH_DRIVER_ITERATIONS},
+    // without a ground station every send fails, after all its auto-retransmits
+    {"send_telemetry", send_telemetry, nullptr, BENCH_DRIVER_WARMUP, BENCH_DRIVER_ITERATIONS, &telemetry_failures},
+};
+
+static void print_results(Bench_Runner& runner, const Bench_Case *benches, size_t count) {
+    char line[BENCH_LINE_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        format_result(runner.run(benches[i]), line, sizeof(line));
+        Serial.println(line);
+    }
+}
+
+void setup(void)
+{
+    Serial.begin(9600);
+    while (!Serial && millis() < 5000) {}
+
+    cycle_counter_init();
+    bno.setup();
+    bmp.setup();
+    gps.setup();
+    lidar.setup(TFMINI_FRAME_RATE_HZ);
+    gimbal.setup();
+    txInit();
+
+    // sensor setup may leave the buses at whatever the libraries chose, pin them down
+    Wire.setClock(BENCH_I2C_HZ);
+    Wire1.setClock(BENCH_I2C_HZ);
+
+    Bench_Runner runner(cycle_count, samples);
+    runner.calibrate();
+
+    // the bus rates are the values requested from Wire/SPI, neither library reads them back
+    char line[BENCH_LINE_SIZE];
+    snprintf(line, sizeof(line),
+             "{\"type\":\"env\",\"board\":\"%s\",\"rev\":\"%s\",\"tick_hz\":%lu,\"f_cpu\":%lu,"
+             "\"f_bus\":%lu,\"i2c_hz_configured\":%lu,\"spi_hz_configured\":%lu,\"gps_baud\":%lu,\"lidar_baud\":%lu,"
+             "\"fixed_point\":%s,\"overhead_ticks\":%lu}",
+             BENCH_BOARD, BENCH_GIT_REV, (unsigned long)CYCLE_COUNTER_HZ, (unsigned long)CYCLE_COUNTER_HZ,
+             (unsigned long)BENCH_F_BUS, (unsigned long)BENCH_I2C_HZ, (unsigned long)RF24_SPI_SPEED,
+             (unsigned long)BENCH_GPS_BAUD, (unsigned long)TFMINI_BAUD_RATE,
+#ifdef TVC_FIXED_POINT
+             "true",
+#else
+             "false",
+#endif
+             (unsigned long)runner.get_overhead());
+    Serial.println(line);
+
+    print_results(runner, driver_benches, sizeof(driver_benches) / sizeof(driver_benches[0]));
+    print_results(runner, compute_benches, num_compute_benches);
+    Serial.println("{\"type\":\"done\"}");
+}
+
+void loop(void)
+{
+}
@@ -0,0 +1,181 @@
+// Ground station firmware: receives the rocket's multiplexed telemetry, prints
+// every record, and sends commands typed on the serial monitor over the ACK
+// uplink (datalog/command_link.h).
+//     pio run -e ground_station -t upload && pio device monitor
+//
+// Commands (one per line):
+//     arm 1 | arm 0
+//     rate <channel id> <hz>
+//     gains <kp> <kd>
+//     status
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stdlib.h>
+#include "datalog/transceiver.h"
+#include "datalog/telemetry_channels.h"
+
+#define GROUND_SESSION_EEPROM_ADDR 0 // uint16_t boot counter, the command session
+#define GROUND_LINE_SIZE 64
+
+static Command_Sender *commands;
+static char line[GROUND_LINE_SIZE];
+static uint8_t line_len = 0;
+static bool was_busy = false;
+static uint32_t last_timeouts = 0;
+
+// A new session on every boot, so the rocket can't take our first command
+// for a repeat of the last one before the reboot.
+static uint16_t next_session() {
+    uint16_t session;
+    EEPROM.get(GROUND_SESSION_EEPROM_ADDR, session);
+    session++;
+    if (session == 0) session = 1;
+    EEPROM.put(GROUND_SESSION_EEPROM_ADDR, session);
+    return session;
+}
+
+static void print_record(uint8_t frameSeq, uint8_t id, const uint8_t *payload, uint8_t len, void *) {
+    switch (id) {
+    case TELEMETRY_CH_ATTITUDE: {
+        if (len != sizeof(Attitude_Record)) break;
+        Attitude_Record r;
+        memcpy(&r, payload, sizeof(r));
+        Serial.print("att us="); Serial.print(r.capture_us);
+        Serial.print(" q=");
+        for (int i = 0; i < 4; i++) {
+            Serial.print((float)r.quat[i] / TELEMETRY_QUAT_SCALE, 4);
+            Serial.print(i < 3 ? "," : "\n");
+        }
+        return;
+    }
+    case TELEMETRY_CH_BARO: {
+        if (len != sizeof(Baro_Record)) break;
+        Baro_Record r;
+        memcpy(&r, payload, sizeof(r));
+        Serial.print("baro us="); Serial.print(r.capture_us);
+        Serial.print(" alt="); Serial.print(r.altitude, 2);
+        Serial.print(" temp="); Serial.println(r.temperature_c100 / 100.0f, 2);
+        return;
+    }
+    case TELEMETRY_CH_LIDAR: {
+        if (len != sizeof(Lidar_Record)) break;
+        Lidar_Record r;
+        memcpy(&r, payload, sizeof(r));
+        Serial.print("lidar us="); Serial.print(r.capture_us);
+        Serial.print(" cm="); Serial.print(r.distance_cm);
+        Serial.print(" strength="); Serial.println(r.strength);
+        return;
+    }
+    case TELEMETRY_CH_GPS: {
+        if (len != sizeof(Gps_Record)) break;
+        Gps_Record r;
+        memcpy(&r, payload, sizeof(r));
+        Serial.print("gps lat="); Serial.print(r.latitude_e7 / 1e7, 6);
+        Serial.print(" lon="); Serial.println(r.longitude_e7 / 1e7, 6);
+        return;
+    }
+    case TELEMETRY_CH_STATUS: {
+        if (len != sizeof(Status_Record)) break;
+        Status_Record r;
+        memcpy(&r, payload, sizeof(r));
+        Serial.print("status armed="); Serial.print(r.armed);
+        Serial.print(" ms="); Serial.print(r.ms);
+        Serial.print(" kp="); Serial.print(r.kp, 4);
+        Serial.print(" kd="); Serial.println(r.kd, 4);
+        return;
+    }
+    case TELEMETRY_CH_FAULT: {
+        if (len != sizeof(Fault_Record)) break;
+        Fault_Record r;
+        memcpy(&r, payload, sizeof(r));
+        // quiet unless something is or was wrong, the record repeats every second
+        if (!r.active && !r.events) return;
+        Serial.print("FAULT ms="); Serial.print(r.ms);
+        Serial.print(" active=0x"); Serial.print(r.active, HEX);
+        Serial.print(" events=0x"); Serial.print(r.events, HEX);
+        Serial.print(" imu_read_failures="); Serial.print(r.imu_read_failures);
+        Serial.print(" baro_read_failures="); Serial.print(r.baro_read_failures);
+        Serial.print(" baro_release_failures="); Serial.println(r.baro_release_failures);
+        return;
+    }
+    case COMMAND_ACK_CHANNEL:
+        return; // reported when the command completes, see loop()
+    }
+    Serial.print("frame "); Serial.print(frameSeq);
+    Serial.print(": unknown record id="); Serial.print(id);
+    Serial.print(" len="); Serial.println(len);
+}
+
+static bool send_line(char *text) {
+    char *cmd = strtok(text, " ");
+    if (!cmd) return false;
+    char *a = strtok(nullptr, " ");
+    char *b = strtok(nullptr, " ");
+
+    if (!strcmp(cmd, "arm") && a) {
+        uint8_t arm = (uint8_t)(atoi(a) != 0);
+        return commands->send(COMMAND_ARM, &arm, 1);
+    }
+    if (!strcmp(cmd, "rate") && a && b) {
+        long rate = atol(b);
+        if (rate < 0 || rate > 0xFFFF) return false;
+        uint8_t args[3] = {(uint8_t)atoi(a), (uint8_t)(rate & 0xFF), (uint8_t)(rate >> 8)};
+        return commands->send(COMMAND_SET_LOG_RATE, args, sizeof(args));
+    }
+    if (!strcmp(cmd, "gains") && a && b) {
+        float gains[2] = {strtof(a, nullptr), strtof(b, nullptr)};
+        uint8_t args[sizeof(gains)];
+        memcpy(args, gains, sizeof(gains));
+        return commands->send(COMMAND_SET_GAINS, args, sizeof(args));
+    }
+    if (!strcmp(cmd, "status")) {
+        return commands->send(COMMAND_REQUEST_STATUS, nullptr, 0);
+    }
+    return false;
+}
+
+static void read_serial_commands() {
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (line_len < GROUND_LINE_SIZE - 1) line[line_len++] = c;
+            continue;
+        }
+        if (line_len == 0) continue;
+        line[line_len] = '\0';
+        line_len = 0;
+        if (commands->busy()) Serial.println("command still in flight, try again");
+        else if (!send_line(line)) Serial.println("bad command");
+    }
+}
+
+static void report_command_result() {
+    bool busy = commands->busy();
+    if (was_busy && !busy) {
+        if (commands->get_timeouts() != last_timeouts) {
+            Serial.println("command timed out, the rocket never picked it up");
+        } else {
+            Serial.print("command confirmed, status="); Serial.print(commands->get_last_status());
+            Serial.print(" rtt_us="); Serial.println(commands->get_last_rtt_us());
+        }
+    }
+    was_busy = busy;
+    last_timeouts = commands->get_timeouts();
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial) {}
+
+    static Command_Sender sender(next_session());
+    commands = &sender;
+    rxInit();
+    Serial.println("Ground station listening...");
+}
+
+void loop() {
+    read_serial_commands();
+    processIncomingFrames(*commands, print_record);
+    report_command_result();
+}
@@ -0,0 +1,149 @@
+#ifndef COMMAND_LINK_H
+#define COMMAND_LINK_H
+
+#include <stdint.h>
+#include "datalog/telemetry_mux.h"
+
+/*
+Ground-to-rocket command uplink carried in nRF24 auto-ack payloads.
+
+The ground station preloads the current command with writeAckPayload(), and
+the radio returns it inside the ACK of the rocket's next telemetry frame. The
+rocket never switches to RX, so commands cost no extra airtime.
+
+Command frame (max 32 bytes, one ack payload):
+    byte 0      COMMAND_MAGIC
+    bytes 1-2   session, little endian (never 0)
+    byte 3      sequence number (1..255, 0 is never used)
+    byte 4      opcode (COMMAND_*)
+    byte 5      argument length n
+    n bytes     arguments, little endian
+    1 byte      CRC-8 (poly 0x07) over everything before it
+
+The ground keeps reloading the same frame into every ack until the rocket
+confirms it, so the rocket sees duplicates. Command_Receiver runs each
+(session, sequence number) once and only re-sends the confirmation for
+repeats. The session changes on every ground station boot: the sequence
+number restarts at 1 after a reboot while the rocket still remembers the
+last one, and without the session the first new command would be taken
+for a repeat and never run.
+
+The confirmation is an urgent telemetry record on COMMAND_ACK_CHANNEL:
+{session (2 bytes), seq, opcode, status}. Command_Sender only accepts it if
+all of session, seq and opcode match the command in flight, then records the
+round trip from first preload to confirmation.
+*/
+
+#define COMMAND_MAGIC 0xC5
+#define COMMAND_HEADER_SIZE 6
+#define COMMAND_MAX_ARGS (32 - COMMAND_HEADER_SIZE - 1)
+#define COMMAND_ACK_CHANNEL 0x7F // telemetry channel id used for confirmations
+#define COMMAND_ACK_SIZE 5
+#define COMMAND_TIMEOUT_US 2000000 // ground gives up on a command after this long
+
+// opcodes
+#define COMMAND_ARM 0x01            // u8: 1 = arm, 0 = disarm
+#define COMMAND_SET_LOG_RATE 0x02   // u8 telemetry channel id, u16 rate in Hz
+#define COMMAND_SET_GAINS 0x03      // float kp, float kd
+#define COMMAND_REQUEST_STATUS 0x04 // no arguments, handler marks its status channel urgent
+
+// status returned by the rocket's handler
+#define COMMAND_STATUS_OK 0
+#define COMMAND_STATUS_REJECTED 1
+#define COMMAND_STATUS_UNKNOWN 2
+#define COMMAND_STATUS_BAD_ARGS 3
+
+struct Command {
+    uint16_t session;
+    uint8_t seq;
+    uint8_t opcode;
+    uint8_t arg_len;
+    uint8_t args[COMMAND_MAX_ARGS];
+};
+
+// Returns the frame length, 0 if the arguments don't fit.
+uint8_t encode_command(const Command& cmd, uint8_t *frame);
+// Returns false on a bad magic, length or CRC, or a 0 session or sequence number.
+bool decode_command(const uint8_t *frame, uint8_t len, Command& cmd);
+uint8_t command_crc8(const uint8_t *data, uint8_t len);
+
+// Rocket side. Returns a COMMAND_STATUS_* code.
+typedef uint8_t (*Command_Handler)(const Command& cmd, void *ctx);
+
+class Command_Receiver {
+public:
+    Command_Receiver(Command_Handler handler, void *ctx);
+
+    // Registers the confirmation channel (rate 0, urgent only) on the telemetry multiplexer.
+    bool attach(Telemetry_Mux& mux);
+
+    // Feed every ack payload the radio returns.
+    void on_ack_payload(const uint8_t *payload, uint8_t len);
+
+    uint32_t get_executed() const { return executed; }
+    uint32_t get_duplicates() const { return duplicates; }
+    uint32_t get_rejected_frames() const { return rejected_frames; }
+
+private:
+    static void fill_ack(uint8_t *buf, void *ctx);
+
+    Command_Handler handler;
+    void *ctx;
+    Telemetry_Mux *mux;
+
+    uint16_t last_session; // 0 = nothing received yet
+    uint8_t last_seq;
+    uint8_t last_opcode;
+    uint8_t last_status;
+
+    uint32_t executed;
+    uint32_t duplicates;
+    uint32_t rejected_frames;
+};
+
+// Ground side: one command in flight at a time.
+class Command_Sender {
+public:
+    // `session` must differ from the previous ground station boot (e.g. a boot
+    // counter kept in EEPROM), 0 is mapped to 1.
+    Command_Sender(uint16_t session);
+
+    // Queues a command. Returns false while the previous one is still in flight.
+    bool send(uint8_t opcode, const uint8_t *args, uint8_t arg_len);
+    void cancel();
+    bool busy() const { return in_flight; }
+
+    // The frame to preload as the next ack payload, false if there is none.
+    bool next_ack_payload(uint32_t now_us, uint8_t *frame, uint8_t& len);
+    // Gives up on the command COMMAND_TIMEOUT_US after its first preload. Returns true if it did.
+    bool check_timeout(uint32_t now_us);
+
+    // Feed COMMAND_ACK_CHANNEL telemetry records. Returns true if it confirmed the command in flight.
+    bool on_confirmation(const uint8_t *payload, uint8_t len, uint32_t now_us);
+
+    uint8_t get_last_status() const { return last_status; }
+    uint32_t get_last_rtt_us() const { return last_rtt_us; }
+    uint32_t get_max_rtt_us() const { return max_rtt_us; }
+    uint32_t get_confirmed() const { return confirmed; }
+    uint32_t get_timeouts() const { return timeouts; }
+    uint32_t get_preloads() const { return preloads; }
+
+private:
+    uint8_t frame[32];
+    uint8_t frame_len;
+    uint16_t session;
+    uint8_t seq;
+    uint8_t opcode;
+    bool in_flight;
+    bool started; // first preload done, first_sent_us is valid
+    uint32_t first_sent_us;
+
+    uint8_t last_status;
+    uint32_t last_rtt_us;
+    uint32_t max_rtt_us;
+    uint32_t confirmed;
+    uint32_t timeouts;
+    uint32_t preloads;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef TELEMETRY_CHANNELS_H
+#define TELEMETRY_CHANNELS_H
+
+#include <stdint.h>
+
+/*
+Downlink channels of the flight firmware (src/main.cpp), decoded by the ground
+station (ground/ground_station.cpp). Records are packed, little endian.
+Command confirmations use COMMAND_ACK_CHANNEL, see datalog/command_link.h.
+Sensor records carry the capture time of their sample (micros() clock), not
+the time the frame was built.
+
+channel    priority   rate     record
+attitude   0          50 Hz    Attitude_Record, 12 bytes
+baro       1          20 Hz    Baro_Record, 10 bytes
+lidar      2          10 Hz    Lidar_Record, 8 bytes
+gps        2          2 Hz     Gps_Record, 8 bytes
+status     1          1 Hz     Status_Record, 13 bytes (also sent on COMMAND_REQUEST_STATUS)
+fault      0          1 Hz     Fault_Record, 12 bytes (also sent urgent when a fault is raised or clears)
+*/
+
+#define TELEMETRY_CH_ATTITUDE 1
+#define TELEMETRY_CH_BARO 2
+#define TELEMETRY_CH_LIDAR 3
+#define TELEMETRY_CH_GPS 4
+#define TELEMETRY_CH_STATUS 5
+#define TELEMETRY_CH_FAULT 6
+
+#define TELEMETRY_ATTITUDE_RATE_HZ 50
+#define TELEMETRY_BARO_RATE_HZ 20
+#define TELEMETRY_LIDAR_RATE_HZ 10
+#define TELEMETRY_GPS_RATE_HZ 2
+#define TELEMETRY_STATUS_RATE_HZ 1
+#define TELEMETRY_FAULT_RATE_HZ 1
+
+#define TELEMETRY_QUAT_SCALE 16384 // quaternion components as int16, 1.0 = 16384
+
+// Fault_Record bits
+#define TELEMETRY_FAULT_IMU_READ 0x01     // IMU I2C read failed (event)
+#define TELEMETRY_FAULT_IMU_STALE 0x02    // no new IMU sample for BNO055_STALE_MS
+#define TELEMETRY_FAULT_BARO_READ 0x04    // barometer data read failed (event)
+#define TELEMETRY_FAULT_BARO_LATCH 0x08   // barometer INT latch could not be released (event)
+#define TELEMETRY_FAULT_BARO_STALE 0x10   // no new barometer sample for BMP388_STALE_MS
+#define TELEMETRY_FAULT_LIDAR_LOST 0x20   // no LiDAR frame for TFMINI_STALE_MS
+
+struct Attitude_Record {
+    uint32_t capture_us;
+    int16_t quat[4]; // w, x, y, z
+} __attribute__((packed));
+
+struct Baro_Record {
+    uint32_t capture_us;
+    float altitude; // m
+    int16_t temperature_c100; // C * 100
+} __attribute__((packed));
+
+struct Lidar_Record {
+    uint32_t capture_us;
+    uint16_t distance_cm;
+    uint16_t strength; // 0 when the reading is unreliable
+} __attribute__((packed));
+
+struct Gps_Record {
+    int32_t latitude_e7; // degrees * 1e7
+    int32_t longitude_e7;
+} __attribute__((packed));
+
+struct Status_Record {
+    uint8_t armed;
+    uint32_t ms;
+    float kp;
+    float kd;
+} __attribute__((packed));
+
+struct Fault_Record {
+    uint32_t ms;
+    uint8_t active; // stale/lost conditions that hold now
+    uint8_t events; // everything raised since the previous fault record, including reads that failed
+    uint16_t imu_read_failures; // totals since boot, saturating
+    uint16_t baro_read_failures;
+    uint16_t baro_release_failures;
+} __attribute__((packed));
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef TELEMETRY_MUX_H
+#define TELEMETRY_MUX_H
+
+#include <stdint.h>
+
+/*
+Multi-rate telemetry multiplexer for the nRF24 downlink.
+
+Each channel declares a payload size, a rate and a priority (0 = highest).
+build_frame() packs every channel that is due into one 32-byte radio frame,
+highest priority first, as long as the airtime budget allows it:
+
+    byte 0         frame sequence number
+    then records   [channel id][payload length][payload ...]
+
+Urgent channels (mark_urgent, e.g. a phase change or a sensor fault) go out in
+the next frame, ahead of everything else and even when over budget.
+report_result() feeds back ack/retry statistics; when the link gets lossy the
+rates of every channel except priority 0 are scaled down, and recover again
+once the link is clean.
+
+Usage:
+    Telemetry_Mux mux(TELEMETRY_DEFAULT_BUDGET_US);
+    mux.add_channel(CH_ATTITUDE, sizeof(Attitude), 0, 50, fill_attitude, &state);
+    mux.add_channel(CH_GPS, sizeof(GpsFix), 2, 2, fill_gps, &gps);
+    ...
+    sendTelemetryFrame(mux); // every loop, see datalog/transceiver.h
+*/
+
+#define TELEMETRY_FRAME_SIZE 32
+#define TELEMETRY_FRAME_HEADER_SIZE 1
+#define TELEMETRY_RECORD_HEADER_SIZE 2
+#define TELEMETRY_MAX_PAYLOAD (TELEMETRY_FRAME_SIZE - TELEMETRY_FRAME_HEADER_SIZE - TELEMETRY_RECORD_HEADER_SIZE)
+#define TELEMETRY_MAX_CHANNELS 16
+
+#define TELEMETRY_DATA_RATE_KBPS 1000 // RF24_1MBPS (library default)
+#define TELEMETRY_DEFAULT_BUDGET_US 250000 // airtime per second, 25% duty cycle
+#define TELEMETRY_MAX_BURST_US 50000 // how much unused budget can be saved up
+
+// rate adaptation: loss is an EWMA of failed sends in 1/65536 units
+#define TELEMETRY_LOSS_HIGH 13107 // 20%, throttle non-critical channels
+#define TELEMETRY_LOSS_LOW 3277   // 5%, let them recover
+#define TELEMETRY_ADAPT_INTERVAL 16 // frames between rate adjustments
+#define TELEMETRY_SCALE_ONE 256     // rate scale 1.0
+#define TELEMETRY_SCALE_MIN 32      // never throttle below 1/8 of the requested rate
+
+// Writes exactly `size` bytes of payload for the channel into buf.
+typedef void (*Telemetry_Fill_Fn)(uint8_t *buf, void *ctx);
+
+// Called by Telemetry_Mux::parse_frame for every record in a received frame.
+typedef void (*Telemetry_Record_Fn)(uint8_t frame_seq, uint8_t id, const uint8_t *payload, uint8_t len, void *ctx);
+
+struct Telemetry_Channel {
+    uint8_t id;
+    uint8_t size;
+    uint8_t priority;
+    bool urgent;
+    uint16_t rate_hz;     // requested rate
+    uint16_t rate_scale;  // adaptive, TELEMETRY_SCALE_ONE = full rate
+    uint32_t period_us;   // effective period after scaling
+    uint32_t next_due_us;
+    uint32_t sent_count;
+    Telemetry_Fill_Fn fill;
+    void *ctx;
+};
+
+struct Telemetry_Link_Stats {
+    uint32_t frames_sent;
+    uint32_t frames_acked;
+    uint32_t retries;
+    uint32_t skipped_budget; // frames held back because the budget was used up
+    uint32_t loss_q16;       // EWMA of lost frames, 65536 = 100%
+};
+
+class Telemetry_Mux {
+public:
+    Telemetry_Mux(uint32_t airtime_budget_us_per_s = TELEMETRY_DEFAULT_BUDGET_US,
+                  uint16_t data_rate_kbps = TELEMETRY_DATA_RATE_KBPS);
+
+    // returns false if the table is full, the id is taken or the payload does not fit a frame
+    bool add_channel(uint8_t id, uint8_t size, uint8_t priority, uint16_t rate_hz,
+                     Telemetry_Fill_Fn fill, void *ctx);
+    void set_rate(uint8_t id, uint16_t rate_hz);
+    void mark_urgent(uint8_t id);
+    void set_airtime_budget(uint32_t airtime_budget_us_per_s);
+
+    // Fills `frame` (TELEMETRY_FRAME_SIZE bytes) with everything due at now_us.
+    // Returns the frame length, 0 if nothing is due or the budget is used up.
+    uint8_t build_frame(uint32_t now_us, uint8_t *frame);
+
+    // Feed back the result of sending the last frame: ack received and the
+    // number of automatic retransmits the radio needed.
+    void report_result(bool acked, uint8_t retries);
+
+    const Telemetry_Link_Stats& get_stats() const { return stats; }
+    const Telemetry_Channel *get_channel(uint8_t id) const;
+
+    // airtime of one frame with `len` payload bytes including the auto-ack
+    uint32_t frame_airtime_us(uint8_t len) const;
+
+    // Ground side: walks the records of a received frame. Returns false if malformed.
+    static bool parse_frame(const uint8_t *frame, uint8_t len, Telemetry_Record_Fn on_record, void *ctx);
+
+private:
+    Telemetry_Channel *find(uint8_t id);
+    void update_period(Telemetry_Channel& ch);
+    void refill(uint32_t now_us);
+    void adapt_rates();
+
+    Telemetry_Channel channels[TELEMETRY_MAX_CHANNELS];
+    uint8_t num_channels;
+
+    uint32_t budget_us_per_s;
+    uint16_t data_rate_kbps;
+    int32_t airtime_tokens_us; // may go negative after an urgent frame
+    uint32_t last_refill_us;
+    bool started;
+
+    uint8_t frame_seq;
+    uint8_t last_frame_len;
+    uint8_t frames_since_adapt;
+    Telemetry_Link_Stats stats;
+};
+
+#endif
@@ -2,6 +2,8 @@
 #define TRANSCEIVER_H
 
 #include <Arduino.h>
+#include "datalog/telemetry_mux.h"
+#include "datalog/command_link.h"
 
 // Hardware pins. Change to match board.
 #define CE_PIN   9
@@ -30,7 +32,9 @@ struct Telemetry {
 void txInit(unsigned long retries = 3, unsigned long delayCycles = 5);
 void rxInit();
 bool sendTelemetry(Telemetry& t);
+bool sendTelemetryFrame(Telemetry_Mux& mux, Command_Receiver *commands = nullptr);
 void processIncomingTelemetry();
+void processIncomingFrames(Command_Sender& commands, Telemetry_Record_Fn onRecord, void *ctx = nullptr);
 void closeLogFile();
 
 #endif 
\ No newline at end of file
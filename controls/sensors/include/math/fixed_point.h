@@ -0,0 +1,121 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Signed fixed-point number in a 32-bit word with FRAC_BITS fractional bits.
+// Every operation saturates to the representable range instead of wrapping,
+// so an overflow in the control loop pins the output instead of flipping sign.
+// Multiplication uses the 32x32->64 multiply, which is single cycle on the Cortex-M4.
+template <int FRAC_BITS>
+class Fixed {
+    static_assert(FRAC_BITS > 0 && FRAC_BITS < 32, "FRAC_BITS must be in [1, 31]");
+
+public:
+    static constexpr int frac_bits = FRAC_BITS;
+    static constexpr int64_t one = int64_t(1) << FRAC_BITS;
+
+    constexpr Fixed() : raw(0) {}
+    // conversions from floating point are meant for constants and setup code,
+    // they are evaluated at compile time when the argument is a constant.
+    // Use from_float() for values only known at run time.
+    constexpr explicit Fixed(double value) : raw(from_double(value)) {}
+
+    template <int OTHER_BITS>
+    constexpr explicit Fixed(Fixed<OTHER_BITS> other) : raw(rescale(other.get_raw(), OTHER_BITS)) {}
+
+    static constexpr Fixed from_raw(int32_t raw) { Fixed f; f.raw = raw; return f; }
+    static constexpr Fixed from_int(int32_t value) { return from_raw(saturate(int64_t(value) * one)); }
+    static constexpr Fixed max_value() { return from_raw(INT32_MAX); }
+    static constexpr Fixed min_value() { return from_raw(INT32_MIN); }
+    static constexpr Fixed epsilon() { return from_raw(1); }
+
+    // Run-time conversion (sensor readings, commands) using integer ops on the
+    // IEEE-754 bits only. Without an FPU, Fixed(double) would go through soft-double.
+    // Rounds half away from zero like Fixed(double), NaN gives 0.
+    static Fixed from_float(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        bool negative = bits >> 31;
+        int32_t exponent = int32_t((bits >> 23) & 0xFF);
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (exponent == 0xFF) {
+            if (mantissa) return from_raw(0);
+            return negative ? min_value() : max_value();
+        }
+        if (exponent == 0) return from_raw(0); // zero and denormals, far below epsilon
+
+        // value = (mantissa | implicit one) * 2^(exponent - 150), raw = value * 2^FRAC_BITS
+        uint64_t magnitude = mantissa | 0x800000;
+        int32_t shift = exponent - 150 + FRAC_BITS;
+        if (shift >= 0) {
+            if (shift > 32) return negative ? min_value() : max_value();
+            magnitude <<= shift;
+        } else {
+            if (shift < -25) return from_raw(0);
+            magnitude = (magnitude + (uint64_t(1) << (-shift - 1))) >> -shift;
+        }
+        return from_raw(saturate(negative ? -int64_t(magnitude) : int64_t(magnitude)));
+    }
+
+    constexpr int32_t get_raw() const { return raw; }
+    constexpr float to_float() const { return float(raw) * (1.0f / float(one)); }
+    constexpr explicit operator float() const { return to_float(); }
+
+    // truncates toward zero, same as casting a float to int
+    constexpr int32_t to_int() const {
+        return raw >= 0 ? int32_t(raw >> FRAC_BITS) : -int32_t((-int64_t(raw)) >> FRAC_BITS);
+    }
+
+    constexpr Fixed operator-() const { return from_raw(saturate(-int64_t(raw))); }
+    constexpr Fixed operator+(Fixed rhs) const { return from_raw(saturate(int64_t(raw) + rhs.raw)); }
+    constexpr Fixed operator-(Fixed rhs) const { return from_raw(saturate(int64_t(raw) - rhs.raw)); }
+
+    constexpr Fixed operator*(Fixed rhs) const {
+        // round to nearest before dropping the extra fractional bits
+        return from_raw(saturate((int64_t(raw) * rhs.raw + (int64_t(1) << (FRAC_BITS - 1))) >> FRAC_BITS));
+    }
+
+    // division goes through a 64-bit divide, keep it out of the hot path
+    constexpr Fixed operator/(Fixed rhs) const {
+        return rhs.raw == 0 ? (raw >= 0 ? max_value() : min_value())
+                            : from_raw(saturate((int64_t(raw) * one) / rhs.raw));
+    }
+
+    Fixed& operator+=(Fixed rhs) { return *this = *this + rhs; }
+    Fixed& operator-=(Fixed rhs) { return *this = *this - rhs; }
+    Fixed& operator*=(Fixed rhs) { return *this = *this * rhs; }
+    Fixed& operator/=(Fixed rhs) { return *this = *this / rhs; }
+
+    constexpr bool operator==(Fixed rhs) const { return raw == rhs.raw; }
+    constexpr bool operator!=(Fixed rhs) const { return raw != rhs.raw; }
+    constexpr bool operator<(Fixed rhs) const { return raw < rhs.raw; }
+    constexpr bool operator>(Fixed rhs) const { return raw > rhs.raw; }
+    constexpr bool operator<=(Fixed rhs) const { return raw <= rhs.raw; }
+    constexpr bool operator>=(Fixed rhs) const { return raw >= rhs.raw; }
+
+private:
+    static constexpr int32_t saturate(int64_t value) {
+        return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : int32_t(value));
+    }
+
+    static constexpr int32_t from_double(double value) {
+        return value * double(one) >= double(INT32_MAX) ? INT32_MAX
+             : value * double(one) <= double(INT32_MIN) ? INT32_MIN
+             : int32_t(value * double(one) + (value >= 0 ? 0.5 : -0.5));
+    }
+
+    static constexpr int32_t rescale(int32_t other_raw, int other_bits) {
+        return other_bits >= FRAC_BITS ? int32_t(other_raw >> (other_bits - FRAC_BITS))
+                                       : saturate(int64_t(other_raw) * (int64_t(1) << (FRAC_BITS - other_bits)));
+    }
+
+    int32_t raw;
+};
+
+using q16_16 = Fixed<16>; // +-32768 with ~1.5e-5 resolution: angles, pulse widths, gains
+using q1_31 = Fixed<31>;  // [-1, 1) with ~4.7e-10 resolution: unit quaternions, normalized values
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef NUMERIC_H
+#define NUMERIC_H
+
+#include <stdint.h>
+#include "math/fixed_point.h"
+
+// Numeric type used by the control path (servo mapping, gimbal, estimators).
+// Boards with an FPU (teensy41) use float. Boards without one (teensy31) would
+// fall back to software float, so they use Q16.16 fixed point instead.
+// platformio.ini sets TVC_FIXED_POINT for the teensy31; FPU-less ARM targets
+// pick it automatically as well.
+#if defined(TVC_FIXED_POINT) || (defined(__arm__) && !defined(__ARM_FP))
+#ifndef TVC_FIXED_POINT
+#define TVC_FIXED_POINT
+#endif
+using real_t = q16_16;
+#else
+using real_t = float;
+#endif
+
+// Helpers that work the same for float and the Fixed types, so templated code
+// does not need to care which one it was given.
+namespace num {
+
+// for run-time values; Fixed uses the integer-only conversion, not Fixed(double)
+inline float from_float(float value, const float *) { return value; }
+template <int F>
+Fixed<F> from_float(float value, const Fixed<F> *) { return Fixed<F>::from_float(value); }
+template <typename T>
+T from_float(float value) { return from_float(value, static_cast<const T *>(nullptr)); }
+
+inline constexpr float to_float(float value) { return value; }
+template <int F>
+constexpr float to_float(Fixed<F> value) { return value.to_float(); }
+
+// truncates toward zero
+inline constexpr int32_t to_int(float value) { return int32_t(value); }
+template <int F>
+constexpr int32_t to_int(Fixed<F> value) { return value.to_int(); }
+
+inline constexpr float from_int(int32_t value, const float *) { return float(value); }
+template <int F>
+constexpr Fixed<F> from_int(int32_t value, const Fixed<F> *) { return Fixed<F>::from_int(value); }
+template <typename T>
+constexpr T from_int(int32_t value) { return from_int(value, static_cast<const T *>(nullptr)); }
+
+template <typename T>
+constexpr T minimum(T a, T b) { return b < a ? b : a; }
+
+template <typename T>
+constexpr T maximum(T a, T b) { return a < b ? b : a; }
+
+template <typename T>
+constexpr T clamp(T value, T lo, T hi) { return value < lo ? lo : (hi < value ? hi : value); }
+
+} // namespace num
+
+#endif
@@ -3,46 +3,58 @@
 
 #include <Servo.h>
 #include "config.h"
+#include "math/numeric.h"
 #include <Arduino.h>
 
 
-class Servo_Axis{
+// Templated on the numeric type (see math/numeric.h) so the teensy31 can run
+// the servo mapping in fixed point. Use the Servo_Axis / Gimbal aliases below.
+template <typename Real>
+class Servo_Axis_T{
 public:
-    Servo_Axis(uint8_t servo_pin);
-    void set_offset(float offset_rads);
-    void set_ratio(float ratio);
-    void set_min_max_range(int minpoint_us, int maxpoint_us, float servo_range_rads);
-    void set_servo_angle(float angle_rads);
-    void set_axis_angle(float angle_rads);
+    Servo_Axis_T(uint8_t servo_pin);
+    void set_offset(Real offset_rads);
+    void set_ratio(Real ratio);
+    void set_min_max_range(int minpoint_us, int maxpoint_us, Real servo_range_rads);
+    void set_servo_angle(Real angle_rads);
+    void set_axis_angle(Real angle_rads);
     void drive_servo();
     void attach();
 private:
-    Servo servo; 
-    float servo_offset_rads;
-    float ratio;
-    float current_servo_angle_rads;
+    Servo servo;
+    Real servo_offset_rads;
+    Real ratio;
+    Real inv_ratio; // 1 / ratio, keeps the division out of set_axis_angle
+    Real current_servo_angle_rads;
 
     int minpoint_us;
     int maxpoint_us;
-    float servo_range_rads;
-    int servo_pin; 
+    Real servo_range_rads;
+    Real half_range_rads;
+    Real midpoint_us;
+    Real us_per_rads;
+    int servo_pin;
 };
 
-class Gimbal{ 
+template <typename Real>
+class Gimbal_T{
 public:
-    Gimbal(Servo_Axis& y_axis, Servo_Axis& z_axis);
-    Gimbal(int y_pin, int z_pin);
+    Gimbal_T(Servo_Axis_T<Real>& y_axis, Servo_Axis_T<Real>& z_axis);
+    Gimbal_T(int y_pin, int z_pin);
 
-    void set_angles(float angle_y_rads, float angle_z_rads);
+    void set_angles(Real angle_y_rads, Real angle_z_rads);
     void drive_servos();
-    void drive_servos(float angle_y_rads, float angle_z_rads);
+    void drive_servos(Real angle_y_rads, Real angle_z_rads);
     void setup();
-    
+
 private:
-    Servo_Axis axis_y;
-    Servo_Axis axis_z;
-    
+    Servo_Axis_T<Real> axis_y;
+    Servo_Axis_T<Real> axis_z;
+
 };
 
+using Servo_Axis = Servo_Axis_T<real_t>;
+using Gimbal = Gimbal_T<real_t>;
+
 
-#endif
\ No newline at end of file
+#endif
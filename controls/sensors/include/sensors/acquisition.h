@@ -0,0 +1,82 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <Arduino.h>
+#include "util/cycle_counter.h"
+
+/*
+Interrupt driven acquisition helpers.
+
+The data-ready interrupt (or sample timer) only latches the cycle counter and
+queues a read. I2C is not interrupt safe, so the read itself happens in
+loop() when the driver's poll_sample() pops the request. Every sample keeps the
+capture timestamp from the interrupt, not the time it was read.
+*/
+
+// Single producer (ISR) / single consumer (loop) ring of capture timestamps.
+// N must be a power of two.
+template <uint8_t N>
+class Stamp_Queue {
+    static_assert(N && (N & (N - 1)) == 0, "Stamp_Queue size must be a power of two");
+
+public:
+    Stamp_Queue() : head(0), tail(0), overruns(0) {}
+
+    // ISR side. When full the newest stamp is dropped and counted.
+    void push(uint32_t stamp) {
+        uint8_t h = head;
+        if ((uint8_t)(h - tail) >= N) {
+            overruns++;
+            return;
+        }
+        stamps[h & (N - 1)] = stamp;
+        head = h + 1;
+    }
+
+    // loop side
+    bool pop(uint32_t& stamp) {
+        uint8_t t = tail;
+        if (t == head) return false;
+        stamp = stamps[t & (N - 1)];
+        tail = t + 1;
+        return true;
+    }
+
+    // loop side: keep only the latest stamp. For sensors that only hold one
+    // sample, older requests describe data that has already been overwritten.
+    bool pop_latest(uint32_t& stamp, uint32_t& skipped) {
+        skipped = 0;
+        if (!pop(stamp)) return false;
+        while (pop(stamp)) skipped++;
+        return true;
+    }
+
+    uint32_t get_overruns() const { return overruns; }
+
+private:
+    volatile uint32_t stamps[N];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile uint32_t overruns;
+};
+
+// Capture-to-consume latency of an acquisition path, in cycles.
+struct Latency_Stats {
+    uint32_t count = 0;
+    uint32_t skipped = 0; // samples overwritten before loop() got to them
+    uint32_t max_cycles = 0;
+    uint64_t total_cycles = 0;
+
+    void add(uint32_t capture_cycles) {
+        uint32_t latency = cycle_count() - capture_cycles;
+        count++;
+        total_cycles += latency;
+        if (latency > max_cycles) max_cycles = latency;
+    }
+
+    uint32_t mean_us() const { return count ? cycles_to_us((uint32_t)(total_cycles / count)) : 0; }
+    uint32_t max_us() const { return cycles_to_us(max_cycles); }
+    void reset() { *this = Latency_Stats(); }
+};
+
+#endif
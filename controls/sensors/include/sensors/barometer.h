@@ -6,21 +6,64 @@
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_BMP3XX.h>
+#include "sensors/acquisition.h"
+#include "sensors/bmp388_compensation.h"
+
+struct Baro_Sample {
+    uint32_t capture_cycles; // cycle counter when the data-ready interrupt fired
+    float temperature; // C
+    float pressure;    // Pa
+    float altitude;    // m
+};
 
 class BMP388_Barometer {
 public:
     BMP388_Barometer(int i2cAddress = BMP3_ADDR_I2C_PRIM, TwoWire *wire = &Wire);
-    
+
     void setup();
 
+    // polled, forced-mode reads (one conversion per call)
     float getTemperature();
     float getPressure();
     float getAltitude();
+    // getAltitude() without the Serial message, for callers that own the output
+    bool read_altitude(float& altitude);
+
+    // Interrupt driven acquisition: puts the sensor in normal mode at
+    // output_data_rate (BMP3_ODR_*) with data-ready on int_pin. Don't mix with
+    // the polled getters above afterwards, they switch back to forced mode.
+    void setup_interrupt(uint8_t int_pin, uint8_t output_data_rate = BMP388_OUTPUT_DATA_RATE);
+    // call from loop(), returns true when a new sample was read
+    bool poll_sample(Baro_Sample& sample);
+    const Latency_Stats& get_latency() const { return latency; }
+    // INT_STATUS reads that failed every retry, leaving the interrupt latched
+    uint32_t get_release_failures() const { return release_failures; }
+    // samples picked up from a latched pin with no edge; they have no capture time
+    uint32_t get_latch_recoveries() const { return latch_recoveries; }
+    // data reads that failed, the sample was dropped
+    uint32_t get_read_failures() const { return read_failures; }
 
 private:
+    static void on_data_ready();
+    static BMP388_Barometer *isr_instance;
+
+    bool write_register(uint8_t reg, uint8_t value);
+    bool read_registers(uint8_t reg, uint8_t *buf, uint8_t len);
+    bool release_interrupt();
+    bool read_calibration();
+
     Adafruit_BMP3XX bmp;
     int i2cAddress;
     TwoWire *wire;
+
+    BMP388_Compensation comp;
+
+    int int_pin; // -1 until setup_interrupt
+    Stamp_Queue<4> pending;
+    Latency_Stats latency;
+    uint32_t release_failures;
+    uint32_t latch_recoveries;
+    uint32_t read_failures;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,53 @@
+#ifndef BMP388_COMPENSATION_H
+#define BMP388_COMPENSATION_H
+
+#include <stdint.h>
+
+/*
+BMP388 compensation with the sensor's own trimming coefficients, in two
+flavours that give the same result:
+
+  float    datasheet section 9.2, for boards with an FPU
+  integer  Bosch BMP3 sensor API without floating point, for the teensy31
+           (TVC_FIXED_POINT) where float compensation and powf() run in
+           software on every sample
+
+No Arduino dependencies, so it also builds on the host.
+*/
+
+#define BMP388_CALIB_SIZE 21 // trimming coefficient bytes from register 0x31
+
+class BMP388_Compensation {
+public:
+    // raw NVM bytes as read from the sensor
+    void set_calibration(const uint8_t *c);
+
+    float temperature_float(uint32_t raw) const;                   // C
+    float pressure_float(uint32_t raw, float temperature) const;   // Pa
+    // same formula as Adafruit_BMP3XX::readAltitude
+    static float altitude_float(float pressure_pa, float sea_level_hpa);
+
+    // t_lin carries the temperature into pressure_int()
+    int32_t temperature_int(uint32_t raw, int64_t& t_lin) const;   // C * 100
+    uint32_t pressure_int(uint32_t raw, int64_t t_lin) const;      // Pa * 100
+    // table lookup of the altitude formula, within 0.15 m of it above 30 kPa
+    static int32_t altitude_mm(uint32_t pressure_centi_pa, uint32_t sea_level_centi_pa);
+
+private:
+    uint16_t par_t1, par_t2;
+    int8_t par_t3;
+    int16_t par_p1, par_p2;
+    int8_t par_p3, par_p4;
+    uint16_t par_p5, par_p6;
+    int8_t par_p7, par_p8;
+    int16_t par_p9;
+    int8_t par_p10, par_p11;
+
+    // par_* already scaled to floating point
+    struct {
+        float t1, t2, t3;
+        float p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11;
+    } scaled;
+};
+
+#endif
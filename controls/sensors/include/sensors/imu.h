@@ -1,19 +1,29 @@
 #ifndef IMU_H
-#define IMU_H   
+#define IMU_H
 
 #include <Arduino.h>
 #include "config.h"
 #include <Wire.h>
 #include <Adafruit_BNO055.h>
 #include <Adafruit_Sensor.h>
+#include "sensors/acquisition.h"
 
 using Vector3 = imu::Vector<3>;
-using Quaternion = imu::Quaternion; 
+using Quaternion = imu::Quaternion;
+
+struct Imu_Sample {
+    uint32_t capture_cycles; // cycle counter when the sample tick fired
+    imu::Quaternion quat;
+    imu::Vector<3> gyro;
+    imu::Vector<3> accel;
+};
+
+#define BNO055_DATA_BLOCK_SIZE 32 // accel, mag, gyro, euler, quaternion registers
 
 class BNO055_IMU {
 public:
     BNO055_IMU(int i2cAddress = BNO055_ADDRESS_A, TwoWire *wire = &Wire);
-    
+
     void setup();
 
     imu::Quaternion getQuaternion();
@@ -22,8 +32,31 @@ public:
     imu::Vector<3> getMagnetometer();
     imu::Vector<3> getLinearAccel();
 
+    // Timed acquisition. The DRDY bits in INT_EN (ACC_BSX, MAG, GYR) fire on the
+    // raw sensor conversions, each at its own rate; nothing signals a new fusion
+    // output. A hardware timer at the fusion rate latches the timestamp instead.
+    void setup_timer(uint32_t rate_hz = BNO055_SAMPLE_RATE_HZ);
+    // call from loop(), returns true when a new (non-duplicate) sample was read
+    bool poll_sample(Imu_Sample& sample);
+    const Latency_Stats& get_latency() const { return latency; }
+    uint32_t get_duplicates() const { return duplicates; }
+    uint32_t get_read_failures() const { return read_failures; }
+
 private:
+    static void on_sample_tick();
+    static BNO055_IMU *isr_instance;
+
+    bool read_registers(uint8_t reg, uint8_t *buf, uint8_t len);
+
     Adafruit_BNO055 bno;
+    int i2cAddress;
+    TwoWire *wire;
+    IntervalTimer timer;
+    Stamp_Queue<4> pending;
+    Latency_Stats latency;
+    uint8_t last_block[BNO055_DATA_BLOCK_SIZE]; // duplicate check covers the whole burst
+    uint32_t duplicates;
+    uint32_t read_failures;
 };
 
-#endif
\ No newline at end of file
+#endif
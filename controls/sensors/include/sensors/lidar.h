@@ -0,0 +1,48 @@
+#ifndef LIDAR_H
+#define LIDAR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "sensors/tfmini_parser.h"
+
+#define TFMINI_DEFAULT_BAUD_RATE 115200 // what the sensor boots with
+#define TFMINI_RX_BUFFER_SIZE 1024      // extra serial RX buffer, ~90 ms of frames at 1 kHz
+#define TFMINI_MIN_STRENGTH 100         // below this (or at 65535) the distance is unreliable
+
+struct Lidar_Sample {
+    uint32_t capture_cycles; // cycle counter when the frame's last byte arrived (estimated)
+    uint16_t distance_cm;
+    uint16_t strength;
+    float temperature;       // C
+    bool valid;
+};
+
+// Benewake TFMini-S on a hardware UART. Never blocks: update() drains whatever
+// is in the RX buffer and parses it.
+class TFMiniS {
+public:
+    TFMiniS(HardwareSerial &lidar_serial, uint32_t baud_rate = TFMINI_BAUD_RATE);
+
+    // Switches the sensor from its boot baud rate to baud_rate and sets the frame rate.
+    // Settings are not saved to the sensor's flash, this runs on every boot.
+    void setup(uint16_t frame_rate_hz = TFMINI_FRAME_RATE_HZ);
+
+    // Call every loop. Returns true if at least one new frame arrived.
+    bool update();
+
+    const Lidar_Sample& get_sample() const { return sample; }
+    float get_distance_meters() const { return sample.distance_cm * 0.01f; }
+    uint32_t get_frame_count() const { return parser.get_stats().frames; }
+    const TFMini_Parser_Stats& get_parser_stats() const { return parser.get_stats(); }
+
+private:
+    void send_command(const uint8_t *cmd, uint8_t len);
+
+    HardwareSerial *lidar_ptr;
+    uint32_t baud_rate;
+    uint32_t cycles_per_byte;
+    TFMini_Frame_Parser parser;
+    Lidar_Sample sample;
+};
+
+#endif
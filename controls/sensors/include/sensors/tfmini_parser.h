@@ -0,0 +1,56 @@
+#ifndef TFMINI_PARSER_H
+#define TFMINI_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Streaming parser for Benewake TFMini-S 9-byte data frames:
+
+    0x59 0x59 Dist_L Dist_H Strength_L Strength_H Temp_L Temp_H Checksum
+
+checksum = low byte of the sum of the first 8 bytes. Bytes can be fed in any
+chunking. On a bad checksum the parser resyncs on the next 0x59 0x59 inside
+the rejected bytes, so a header hidden in noise is not lost.
+No Arduino dependencies, so it also builds on the host.
+*/
+
+#define TFMINI_FRAME_SIZE 9
+#define TFMINI_HEADER 0x59
+
+struct TFMini_Frame {
+    uint16_t distance_cm;
+    uint16_t strength;
+    uint16_t temperature_raw; // degC = raw / 8 - 256
+    uint16_t end_offset;      // index one past the frame's last byte in the chunk given to parse()
+};
+
+struct TFMini_Parser_Stats {
+    uint32_t frames;
+    uint32_t checksum_errors;
+    uint32_t bytes_discarded;
+};
+
+class TFMini_Frame_Parser {
+public:
+    TFMini_Frame_Parser();
+
+    // Feeds one byte. Returns true and fills frame when it completed a valid frame.
+    bool push(uint8_t byte, TFMini_Frame& frame);
+
+    // Feeds a chunk, storing up to max_frames completed frames in order.
+    // Returns how many were stored; frames beyond max_frames are still counted in stats.
+    size_t parse(const uint8_t *data, size_t len, TFMini_Frame *frames, size_t max_frames);
+
+    void reset();
+    const TFMini_Parser_Stats& get_stats() const { return stats; }
+
+private:
+    void resync();
+
+    uint8_t buf[TFMINI_FRAME_SIZE];
+    uint8_t count;
+    TFMini_Parser_Stats stats;
+};
+
+#endif
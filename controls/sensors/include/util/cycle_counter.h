@@ -0,0 +1,36 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <Arduino.h>
+
+// Free-running CPU cycle counter (DWT CYCCNT) for timestamps and timing.
+// Wraps after 2^32 cycles (7.1 s at 600 MHz, 44.7 s at 96 MHz), so only ever
+// compare timestamps by subtracting them.
+
+#if defined(__IMXRT1062__)
+#define CYCLE_COUNTER_HZ F_CPU_ACTUAL
+#else
+#define CYCLE_COUNTER_HZ F_CPU
+#endif
+
+// The teensy41 core enables the counter at boot, the teensy31 core does not.
+inline void cycle_counter_init() {
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+}
+
+inline uint32_t cycle_count() {
+    return ARM_DWT_CYCCNT;
+}
+
+inline uint32_t cycles_to_us(uint32_t cycles) {
+    return (uint32_t)((uint64_t)cycles * 1000000u / CYCLE_COUNTER_HZ);
+}
+
+// micros() at the time of a cycle counter stamp, for logging and telemetry.
+// Convert it while the stamp is fresh: it must be less than one wrap old.
+inline uint32_t stamp_to_micros(uint32_t stamp) {
+    return (uint32_t)micros() - cycles_to_us(cycle_count() - stamp);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MEMORY_PLACEMENT_H
+#define MEMORY_PLACEMENT_H
+
+#include <Arduino.h>
+
+/*
+Memory placement plan
+
+Teensy 4.1 (IMXRT1062):
+    - ITCM  : all code by default. The core's linker script copies every
+              function not marked FLASHMEM into ITCM at boot, and ITCM takes
+              32K FlexRAM banks away from DTCM.
+    - FLASH : cold code (setup, init, shutdown) -> TVC_FLASHMEM, runs through
+              the cache so ITCM stays small. Library code can't be marked and
+              stays in ITCM.
+    - DTCM  : all globals/statics and the stack.
+    - OCRAM : large log/telemetry buffers -> TVC_DMAMEM (cached, not zeroed at boot)
+
+    TVC_FASTRUN marks the hot path: servo drive, the acquisition ISRs and
+    sample reads, the LiDAR drain and parser, and telemetry frame building
+    and sending. On the teensy41 it lands in ITCM like any other unmarked
+    code; the marker says the function must never become TVC_FLASHMEM.
+
+Teensy 3.1 (MK20DX256):
+    - Only 64K of RAM, so code is never copied to RAM and every macro except
+      TVC_DMAMEM's alignment is a no-op. Buffers stay in normal RAM.
+
+scripts/memory_budget.py checks the result against the budgets in platformio.ini.
+*/
+
+#if defined(__IMXRT1062__)
+#define TVC_FASTRUN FASTRUN
+#define TVC_FLASHMEM FLASHMEM
+#define TVC_DMAMEM DMAMEM
+#else
+#define TVC_FASTRUN
+#define TVC_FLASHMEM
+#define TVC_DMAMEM __attribute__((aligned(32)))
+#endif
+
+#endif
@@ -0,0 +1,17 @@
+"""
+Build flag with the short git revision, so benchmark output can be matched to
+the commit it was measured on. Used from platformio.ini:
+
+    build_flags = !python scripts/git_rev.py
+"""
+
+import subprocess
+
+try:
+    rev = subprocess.check_output(
+        ["git", "describe", "--always", "--dirty"], stderr=subprocess.DEVNULL, text=True
+    ).strip()
+except (OSError, subprocess.CalledProcessError):
+    rev = "unknown"
+
+print('-D BENCH_GIT_REV=\\"%s\\"' % rev)
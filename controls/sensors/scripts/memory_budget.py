@@ -0,0 +1,184 @@
+"""
+Post-build memory budget report.
+
+Links with a map file, parses it after the .elf is built and prints how much of
+each linker memory region is used. The build fails if a region goes over the
+budget set in platformio.ini, e.g.
+
+    custom_memory_budget = FLEXRAM:480K, RAM:448K, FLASH:4096K
+
+Region names are the ones in the board's linker script
+(teensy41: ITCM, DTCM, RAM (OCRAM), FLASH, ERAM / teensy31: FLASH, RAM).
+FLEXRAM is the teensy41's ITCM (rounded up to 32K banks) plus DTCM. The
+linker sizes ITCM to fit all code not marked FLASHMEM, so the split between
+the two moves from build to build and only their sum is worth budgeting.
+
+Budgets come from a real build's report, not from the hardware sizes (the
+linker already enforces those). Regions that are in use but have no budget get
+a suggested line with SUGGEST_HEADROOM over what this build used.
+"""
+
+import re
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+MAP_PATH = env.subst("$BUILD_DIR/${PROGNAME}.map")  # noqa: F821
+env.Append(LINKFLAGS=["-Wl,-Map," + MAP_PATH])  # noqa: F821
+
+# non-allocated sections show up at address 0 and must not be counted
+NON_ALLOC_PREFIXES = (".debug", ".comment", ".ARM.attributes", ".stab", ".note", ".gnu.attributes")
+
+# IMXRT1062 ITCM and DTCM share 512K of FlexRAM, handed out in 32K banks
+FLEXRAM_SIZE = 512 * 1024
+FLEXRAM_BANK = 32 * 1024
+
+HEX = r"0x[0-9a-fA-F]+"
+
+SUGGEST_HEADROOM = 1.25
+SUGGEST_ROUND = 4 * 1024
+
+
+def parse_size(text):
+    text = text.strip().upper()
+    scale = 1
+    if text.endswith("K"):
+        scale, text = 1024, text[:-1]
+    elif text.endswith("M"):
+        scale, text = 1024 * 1024, text[:-1]
+    return int(text, 0) * scale
+
+
+def parse_budgets(text):
+    budgets = {}
+    for item in re.split(r"[,\n]", text or ""):
+        if ":" not in item:
+            continue
+        name, size = item.split(":", 1)
+        budgets[name.strip()] = parse_size(size)
+    return budgets
+
+
+def parse_map(path):
+    """Returns ({region: (origin, length)}, [(section, vma, size, lma)])."""
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    regions = {}
+    sections = []
+    state = None
+    pending = None
+    for line in lines:
+        if line.startswith("Memory Configuration"):
+            state = "memory"
+            continue
+        if line.startswith("Linker script and memory map"):
+            state = "sections"
+            continue
+
+        if state == "memory":
+            m = re.match(r"^(\S+)\s+(%s)\s+(%s)" % (HEX, HEX), line)
+            if m and m.group(1) != "*default*":
+                regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+        elif state == "sections":
+            # output sections start in column 0; long names wrap onto the next line
+            m = re.match(r"^(\.\S+)\s*$", line)
+            if m:
+                pending = m.group(1)
+                continue
+            m = re.match(r"^(\.\S+)?\s+(%s)\s+(%s)(?:\s+load address\s+(%s))?\s*$" % (HEX, HEX, HEX), line)
+            name = None
+            if m and m.group(1):
+                name = m.group(1)
+            elif m and pending:
+                name = pending
+            pending = None
+            if name and not name.startswith(NON_ALLOC_PREFIXES):
+                vma, size = int(m.group(2), 16), int(m.group(3), 16)
+                lma = int(m.group(4), 16) if m.group(4) else vma
+                if size:
+                    sections.append((name, vma, size, lma))
+    return regions, sections
+
+
+def region_of(regions, addr):
+    for name, (origin, length) in regions.items():
+        if origin <= addr < origin + length:
+            return name
+    return None
+
+
+def region_usage(regions, sections):
+    used = dict.fromkeys(regions, 0)
+    for name, vma, size, lma in sections:
+        region = region_of(regions, vma)
+        if region:
+            used[region] += size
+        # initialised data and ITCM code also take up room at their load address
+        load_region = region_of(regions, lma)
+        if load_region and load_region != region:
+            used[load_region] += size
+    return used
+
+
+def format_size(size):
+    return "%dK" % (size // 1024) if size % 1024 == 0 else str(size)
+
+
+def suggest_budgets(budgets, used):
+    """custom_memory_budget line with the given budgets plus one for every used region that has none."""
+    items = dict(budgets)
+    for name, size in used.items():
+        if name not in items and size:
+            items[name] = -(-int(size * SUGGEST_HEADROOM) // SUGGEST_ROUND) * SUGGEST_ROUND
+    return ", ".join("%s:%s" % (name, format_size(size)) for name, size in items.items())
+
+
+def report(source, target, env):
+    regions, sections = parse_map(MAP_PATH)
+    used = region_usage(regions, sections)
+    budgets = parse_budgets(env.GetProjectOption("custom_memory_budget", ""))
+
+    print("Memory usage (%s):" % env.subst("$PIOENV"))
+    print("  %-8s %10s %10s %10s %7s" % ("region", "used", "budget", "size", "of bgt"))
+    failed = []
+    for name, (origin, length) in regions.items():
+        budget = budgets.get(name)
+        percent = "%6.1f%%" % (100.0 * used[name] / budget) if budget else "      -"
+        print("  %-8s %10d %10s %10d %s" % (name, used[name], budget if budget else "-", length, percent))
+        if budget is not None and used[name] > budget:
+            failed.append("%s uses %d bytes, budget is %d" % (name, used[name], budget))
+
+    budgeted_used = dict(used)
+    if "ITCM" in used and "DTCM" in used:
+        itcm_banks = -(-used["ITCM"] // FLEXRAM_BANK)
+        dtcm_free = FLEXRAM_SIZE - itcm_banks * FLEXRAM_BANK - used["DTCM"]
+        print("  FlexRAM: %d x 32K banks for ITCM, %d bytes left for stack" % (itcm_banks, dtcm_free))
+        if dtcm_free < 0:
+            failed.append("ITCM + DTCM overflow FlexRAM by %d bytes" % -dtcm_free)
+        flexram_used = itcm_banks * FLEXRAM_BANK + used["DTCM"]
+        # budgeted together, never one by one
+        del budgeted_used["ITCM"], budgeted_used["DTCM"]
+        budgeted_used["FLEXRAM"] = flexram_used
+        budget = budgets.get("FLEXRAM")
+        if budget is not None and flexram_used > budget:
+            failed.append("FLEXRAM uses %d bytes, budget is %d" % (flexram_used, budget))
+
+    unbudgeted = [name for name, size in budgeted_used.items() if size and name not in budgets]
+    if unbudgeted:
+        print("  no budget for %s; with %d%% headroom over this build:"
+              % (", ".join(unbudgeted), round((SUGGEST_HEADROOM - 1) * 100)))
+        print("  custom_memory_budget = " + suggest_budgets(budgets, budgeted_used))
+
+    budgets.pop("FLEXRAM", None)
+
+    for budget in set(budgets) - set(regions):
+        print("  warning: budget for unknown region %s" % budget)
+
+    if failed:
+        for msg in failed:
+            print("Memory budget exceeded: " + msg)
+        return 1
+    return 0
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)  # noqa: F821
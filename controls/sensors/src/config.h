@@ -19,8 +19,8 @@
 // hardware setup: 
 
 //servo settings
-#define SERVO_PIN_Y 9
-#define SERVO_PIN_Z 10
+#define SERVO_PIN_Y 2 // 9 and 10 are the radio's CE/CSN (datalog/transceiver.h)
+#define SERVO_PIN_Z 3
 #define SERVO_OFFSET_Y 0 // radians
 #define SERVO_OFFSET_Z 0 // radians
 #define GIMBAL_RATIO 1.0 // output to input gear ratio (rad/rad or unitless)
@@ -29,13 +29,38 @@
 #define SERVO_RANGE_RADS (PI) // radians, total range of motion for servo
 
 
+// control gains (tilt rad -> gimbal rad), a starting point from tools/montecarlo,
+// can be changed over the radio with COMMAND_SET_GAINS
+#define CONTROL_DEFAULT_KP 1.0
+#define CONTROL_DEFAULT_KD 0.1
+
+
 // bno055 imu 
 #define BNO055_I2C_ADDRESS BNO055_ADDRESS_A // default i2c address for bno055
 #define BNO055_WIRE &Wire
+#define BNO055_SAMPLE_RATE_HZ 100 // fusion output rate, no interrupt marks a new fusion output
+#define BNO055_STALE_MS 100 // no new sample for this long is reported as a fault
 
 // bmp388 barometric pressure sensor
 #define BMP388_I2C_ADDRESS 0x77 // default i2c address for bmp388
 #define BMP388_WIRE &Wire1
+#define BMP388_INT_PIN 20 // data-ready interrupt
+#define BMP388_OUTPUT_DATA_RATE BMP3_ODR_50_HZ
+#define BMP388_PRESSURE_OVERSAMPLING BMP3_OVERSAMPLING_4X // conversion must fit in one ODR period
+#define BMP388_TEMPERATURE_OVERSAMPLING BMP3_NO_OVERSAMPLING
+#define BMP388_STALE_MS 200 // 10 missed conversions at 50 Hz
+
+// tfmini-s lidar
+// pins 7/8 on both boards, but a different UART; on the teensy31 Serial2 is
+// on pins 9/10, which the servos and the radio use
+#if defined(__IMXRT1062__)
+#define TFMINI_SERIAL Serial2 // RX2 (7) / TX2 (8)
+#else
+#define TFMINI_SERIAL Serial3 // RX3 (7) / TX3 (8)
+#endif
+#define TFMINI_BAUD_RATE 460800 // 1 kHz of 9 byte frames needs at least 90 kbaud
+#define TFMINI_FRAME_RATE_HZ 1000
+#define TFMINI_STALE_MS 100
 
 // environmental setup:
 #define SEA_LEVEL_PRESSURE_HPA (1013.25) // local sea level pressure
@@ -0,0 +1,166 @@
+#include "datalog/command_link.h"
+#include <string.h>
+
+uint8_t command_crc8(const uint8_t *data, uint8_t len) {
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint8_t encode_command(const Command& cmd, uint8_t *frame) {
+    if (cmd.arg_len > COMMAND_MAX_ARGS) return 0;
+    frame[0] = COMMAND_MAGIC;
+    frame[1] = cmd.session & 0xFF;
+    frame[2] = cmd.session >> 8;
+    frame[3] = cmd.seq;
+    frame[4] = cmd.opcode;
+    frame[5] = cmd.arg_len;
+    memcpy(&frame[COMMAND_HEADER_SIZE], cmd.args, cmd.arg_len);
+    uint8_t len = COMMAND_HEADER_SIZE + cmd.arg_len;
+    frame[len] = command_crc8(frame, len);
+    return len + 1;
+}
+
+bool decode_command(const uint8_t *frame, uint8_t len, Command& cmd) {
+    if (len < COMMAND_HEADER_SIZE + 1 || frame[0] != COMMAND_MAGIC) return false;
+    uint8_t arg_len = frame[5];
+    if (arg_len > COMMAND_MAX_ARGS || len < COMMAND_HEADER_SIZE + arg_len + 1) return false;
+    if (command_crc8(frame, COMMAND_HEADER_SIZE + arg_len) != frame[COMMAND_HEADER_SIZE + arg_len]) return false;
+    uint16_t session = (uint16_t)(frame[1] | frame[2] << 8);
+    if (session == 0 || frame[3] == 0) return false;
+
+    cmd.session = session;
+    cmd.seq = frame[3];
+    cmd.opcode = frame[4];
+    cmd.arg_len = arg_len;
+    memcpy(cmd.args, &frame[COMMAND_HEADER_SIZE], arg_len);
+    return true;
+}
+
+
+Command_Receiver::Command_Receiver(Command_Handler handler, void *ctx) {
+    this->handler = handler;
+    this->ctx = ctx;
+    mux = nullptr;
+    last_session = 0;
+    last_seq = 0;
+    last_opcode = 0;
+    last_status = 0;
+    executed = 0;
+    duplicates = 0;
+    rejected_frames = 0;
+}
+
+bool Command_Receiver::attach(Telemetry_Mux& mux) {
+    this->mux = &mux;
+    return mux.add_channel(COMMAND_ACK_CHANNEL, COMMAND_ACK_SIZE, 0, 0, fill_ack, this);
+}
+
+void Command_Receiver::fill_ack(uint8_t *buf, void *ctx) {
+    Command_Receiver *self = (Command_Receiver *)ctx;
+    buf[0] = self->last_session & 0xFF;
+    buf[1] = self->last_session >> 8;
+    buf[2] = self->last_seq;
+    buf[3] = self->last_opcode;
+    buf[4] = self->last_status;
+}
+
+void Command_Receiver::on_ack_payload(const uint8_t *payload, uint8_t len) {
+    Command cmd;
+    if (!decode_command(payload, len, cmd)) {
+        rejected_frames++;
+        return;
+    }
+
+    // a repeat of the last command only gets its confirmation again
+    if (cmd.session == last_session && cmd.seq == last_seq) {
+        duplicates++;
+    } else {
+        last_session = cmd.session;
+        last_seq = cmd.seq;
+        last_opcode = cmd.opcode;
+        last_status = handler(cmd, ctx);
+        executed++;
+    }
+    if (mux) mux->mark_urgent(COMMAND_ACK_CHANNEL);
+}
+
+
+Command_Sender::Command_Sender(uint16_t session) {
+    frame_len = 0;
+    this->session = session ? session : 1;
+    seq = 0;
+    opcode = 0;
+    in_flight = false;
+    started = false;
+    first_sent_us = 0;
+    last_status = 0;
+    last_rtt_us = 0;
+    max_rtt_us = 0;
+    confirmed = 0;
+    timeouts = 0;
+    preloads = 0;
+}
+
+bool Command_Sender::send(uint8_t opcode, const uint8_t *args, uint8_t arg_len) {
+    if (in_flight || arg_len > COMMAND_MAX_ARGS) return false;
+
+    // skip 0 on wrap so the rocket's "nothing received" state never matches
+    seq = seq == 255 ? 1 : seq + 1;
+    this->opcode = opcode;
+    Command cmd;
+    cmd.session = session;
+    cmd.seq = seq;
+    cmd.opcode = opcode;
+    cmd.arg_len = arg_len;
+    if (arg_len) memcpy(cmd.args, args, arg_len);
+
+    frame_len = encode_command(cmd, frame);
+    in_flight = true;
+    started = false;
+    return true;
+}
+
+void Command_Sender::cancel() {
+    in_flight = false;
+}
+
+bool Command_Sender::next_ack_payload(uint32_t now_us, uint8_t *out, uint8_t& len) {
+    if (!in_flight) return false;
+    if (check_timeout(now_us)) return false;
+    if (!started) {
+        started = true;
+        first_sent_us = now_us;
+    }
+
+    memcpy(out, frame, frame_len);
+    len = frame_len;
+    preloads++;
+    return true;
+}
+
+bool Command_Sender::check_timeout(uint32_t now_us) {
+    if (!in_flight || !started || now_us - first_sent_us <= COMMAND_TIMEOUT_US) return false;
+    in_flight = false;
+    timeouts++;
+    return true;
+}
+
+bool Command_Sender::on_confirmation(const uint8_t *payload, uint8_t len, uint32_t now_us) {
+    if (!in_flight || !started || len < COMMAND_ACK_SIZE) return false;
+    // a confirmation left over from another session or command must not confirm this one
+    uint16_t ack_session = (uint16_t)(payload[0] | payload[1] << 8);
+    if (ack_session != session || payload[2] != seq || payload[3] != opcode) return false;
+
+    in_flight = false;
+    last_status = payload[4];
+    last_rtt_us = now_us - first_sent_us;
+    if (last_rtt_us > max_rtt_us) max_rtt_us = last_rtt_us;
+    confirmed++;
+    return true;
+}
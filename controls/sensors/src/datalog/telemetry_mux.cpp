@@ -0,0 +1,226 @@
+#include "datalog/telemetry_mux.h"
+#include "util/memory_placement.h"
+#include <string.h>
+
+// nRF24 on-air overhead (bits): preamble + 5 byte address + packet control field + 2 byte CRC
+#define NRF24_OVERHEAD_BITS (8 + 40 + 9 + 16)
+#define NRF24_SETTLE_US 130 // PLL settling before every TX and before the ack
+
+// channel id 0 is reserved, it is what zero padding after the last record looks like
+#define TELEMETRY_PADDING_ID 0
+
+
+// wrap-safe "a is at or after b" for micros() timestamps
+static inline bool time_reached(uint32_t now_us, uint32_t due_us) {
+    return (int32_t)(now_us - due_us) >= 0;
+}
+
+Telemetry_Mux::Telemetry_Mux(uint32_t airtime_budget_us_per_s, uint16_t data_rate_kbps) {
+    num_channels = 0;
+    budget_us_per_s = airtime_budget_us_per_s;
+    this->data_rate_kbps = data_rate_kbps;
+    airtime_tokens_us = 0;
+    last_refill_us = 0;
+    started = false;
+    frame_seq = 0;
+    last_frame_len = 0;
+    frames_since_adapt = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool Telemetry_Mux::add_channel(uint8_t id, uint8_t size, uint8_t priority, uint16_t rate_hz,
+                                Telemetry_Fill_Fn fill, void *ctx) {
+    if (num_channels >= TELEMETRY_MAX_CHANNELS || id == TELEMETRY_PADDING_ID || find(id)) return false;
+    if (size == 0 || size > TELEMETRY_MAX_PAYLOAD || fill == nullptr) return false;
+
+    Telemetry_Channel& ch = channels[num_channels++];
+    ch.id = id;
+    ch.size = size;
+    ch.priority = priority;
+    ch.urgent = false;
+    ch.rate_hz = rate_hz;
+    ch.rate_scale = TELEMETRY_SCALE_ONE;
+    ch.next_due_us = last_refill_us; // due right away, re-based on the first build_frame if not started
+    ch.sent_count = 0;
+    ch.fill = fill;
+    ch.ctx = ctx;
+    update_period(ch);
+    return true;
+}
+
+void Telemetry_Mux::set_rate(uint8_t id, uint16_t rate_hz) {
+    Telemetry_Channel *ch = find(id);
+    if (!ch) return;
+    // a disabled channel's due time is stale, it could read as far in the future after a micros() half wrap
+    if (ch->period_us == 0) ch->next_due_us = last_refill_us;
+    ch->rate_hz = rate_hz;
+    update_period(*ch);
+}
+
+void Telemetry_Mux::mark_urgent(uint8_t id) {
+    Telemetry_Channel *ch = find(id);
+    if (ch) ch->urgent = true;
+}
+
+void Telemetry_Mux::set_airtime_budget(uint32_t airtime_budget_us_per_s) {
+    budget_us_per_s = airtime_budget_us_per_s;
+}
+
+const Telemetry_Channel *Telemetry_Mux::get_channel(uint8_t id) const {
+    for (uint8_t i = 0; i < num_channels; i++) {
+        if (channels[i].id == id) return &channels[i];
+    }
+    return nullptr;
+}
+
+Telemetry_Channel *Telemetry_Mux::find(uint8_t id) {
+    return const_cast<Telemetry_Channel *>(get_channel(id));
+}
+
+// rate 0 means the channel is only ever sent when marked urgent
+void Telemetry_Mux::update_period(Telemetry_Channel& ch) {
+    uint32_t scaled = (uint32_t)ch.rate_hz * ch.rate_scale;
+    ch.period_us = scaled ? (uint32_t)(1000000ULL * TELEMETRY_SCALE_ONE / scaled) : 0;
+}
+
+uint32_t Telemetry_Mux::frame_airtime_us(uint8_t len) const {
+    uint32_t frame_bits = NRF24_OVERHEAD_BITS + 8u * len;
+    uint32_t ack_bits = NRF24_OVERHEAD_BITS;
+    return 2 * NRF24_SETTLE_US + (frame_bits + ack_bits) * 1000u / data_rate_kbps;
+}
+
+TVC_FASTRUN void Telemetry_Mux::refill(uint32_t now_us) {
+    if (!started) {
+        started = true;
+        last_refill_us = now_us;
+        airtime_tokens_us = TELEMETRY_MAX_BURST_US;
+        // due times are only comparable within 2^31 us of now, so start them at now
+        // instead of 0 (which reads as "in the future" after ~36 min of uptime)
+        for (uint8_t i = 0; i < num_channels; i++) channels[i].next_due_us = now_us;
+        return;
+    }
+    uint32_t elapsed = now_us - last_refill_us;
+    last_refill_us = now_us;
+    uint64_t earned = (uint64_t)elapsed * budget_us_per_s / 1000000u;
+    int64_t tokens = (int64_t)airtime_tokens_us + (int64_t)earned;
+    airtime_tokens_us = tokens > TELEMETRY_MAX_BURST_US ? TELEMETRY_MAX_BURST_US : (int32_t)tokens;
+}
+
+TVC_FASTRUN uint8_t Telemetry_Mux::build_frame(uint32_t now_us, uint8_t *frame) {
+    refill(now_us);
+
+    // collect due channels, urgent first, then by priority, then the most overdue
+    uint8_t order[TELEMETRY_MAX_CHANNELS];
+    uint8_t num_due = 0;
+    for (uint8_t i = 0; i < num_channels; i++) {
+        Telemetry_Channel& ch = channels[i];
+        bool due = ch.period_us && time_reached(now_us, ch.next_due_us);
+        if (!due && !ch.urgent) continue;
+
+        uint8_t j = num_due++;
+        for (; j > 0; j--) {
+            const Telemetry_Channel& prev = channels[order[j - 1]];
+            bool before = ch.urgent != prev.urgent ? ch.urgent
+                        : ch.priority != prev.priority ? ch.priority < prev.priority
+                        : (int32_t)(ch.next_due_us - prev.next_due_us) < 0;
+            if (!before) break;
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+    if (num_due == 0) return 0;
+
+    // first fit into the frame, a record that does not fit waits for the next one
+    uint8_t packed[TELEMETRY_MAX_CHANNELS];
+    uint8_t num_packed = 0;
+    uint8_t len = TELEMETRY_FRAME_HEADER_SIZE;
+    bool has_urgent = false;
+    for (uint8_t k = 0; k < num_due; k++) {
+        const Telemetry_Channel& ch = channels[order[k]];
+        if (len + TELEMETRY_RECORD_HEADER_SIZE + ch.size > TELEMETRY_FRAME_SIZE) continue;
+        len += TELEMETRY_RECORD_HEADER_SIZE + ch.size;
+        packed[num_packed++] = order[k];
+        has_urgent |= ch.urgent;
+    }
+
+    // urgent frames go out regardless and are paid back from future budget
+    uint32_t airtime = frame_airtime_us(len);
+    if (!has_urgent && airtime_tokens_us < (int32_t)airtime) {
+        stats.skipped_budget++;
+        return 0;
+    }
+    airtime_tokens_us -= airtime;
+
+    frame[0] = ++frame_seq;
+    uint8_t pos = TELEMETRY_FRAME_HEADER_SIZE;
+    for (uint8_t k = 0; k < num_packed; k++) {
+        Telemetry_Channel& ch = channels[packed[k]];
+        frame[pos++] = ch.id;
+        frame[pos++] = ch.size;
+        ch.fill(&frame[pos], ch.ctx);
+        pos += ch.size;
+
+        if (ch.period_us && time_reached(now_us, ch.next_due_us)) {
+            ch.next_due_us += ch.period_us;
+            // more than a period behind (startup, throttling, urgent traffic): don't burst to catch up
+            if (time_reached(now_us, ch.next_due_us)) ch.next_due_us = now_us + ch.period_us;
+        }
+        ch.urgent = false;
+        ch.sent_count++;
+    }
+
+    last_frame_len = len;
+    return len;
+}
+
+TVC_FASTRUN void Telemetry_Mux::report_result(bool acked, uint8_t retries) {
+    stats.frames_sent++;
+    if (acked) stats.frames_acked++;
+    stats.retries += retries;
+
+    // every retransmit burned another frame worth of airtime
+    airtime_tokens_us -= (int32_t)(retries * frame_airtime_us(last_frame_len));
+
+    int32_t sample = acked ? 0 : 65536;
+    stats.loss_q16 += (sample - (int32_t)stats.loss_q16) / 16;
+
+    if (++frames_since_adapt >= TELEMETRY_ADAPT_INTERVAL) {
+        frames_since_adapt = 0;
+        adapt_rates();
+    }
+}
+
+// priority 0 channels always run at their requested rate
+void Telemetry_Mux::adapt_rates() {
+    for (uint8_t i = 0; i < num_channels; i++) {
+        Telemetry_Channel& ch = channels[i];
+        if (ch.priority == 0) continue;
+
+        uint16_t scale = ch.rate_scale;
+        if (stats.loss_q16 > TELEMETRY_LOSS_HIGH) {
+            scale = scale / 2 < TELEMETRY_SCALE_MIN ? TELEMETRY_SCALE_MIN : scale / 2;
+        } else if (stats.loss_q16 < TELEMETRY_LOSS_LOW) {
+            scale = scale + TELEMETRY_SCALE_MIN > TELEMETRY_SCALE_ONE ? TELEMETRY_SCALE_ONE : scale + TELEMETRY_SCALE_MIN;
+        }
+        if (scale != ch.rate_scale) {
+            ch.rate_scale = scale;
+            update_period(ch);
+        }
+    }
+}
+
+bool Telemetry_Mux::parse_frame(const uint8_t *frame, uint8_t len, Telemetry_Record_Fn on_record, void *ctx) {
+    if (len < TELEMETRY_FRAME_HEADER_SIZE || len > TELEMETRY_FRAME_SIZE) return false;
+
+    uint8_t pos = TELEMETRY_FRAME_HEADER_SIZE;
+    while (pos + TELEMETRY_RECORD_HEADER_SIZE <= len) {
+        uint8_t id = frame[pos];
+        uint8_t size = frame[pos + 1];
+        if (id == TELEMETRY_PADDING_ID) break;
+        pos += TELEMETRY_RECORD_HEADER_SIZE;
+        if (pos + size > len) return false;
+        on_record(frame[0], id, &frame[pos], size, ctx);
+        pos += size;
+    }
+    return true;
+}
@@ -3,6 +3,7 @@
 #include <RF24.h>
 #include <SD.h>
 #include "../include/datalog/transceiver.h"
+#include "../include/util/memory_placement.h"
 
 // Unique pipe/address (5 byte address or 64 bits). Same on both boards.
 const uint64_t RADIO_PIPE = 0xE8E8F0F0E1LL;
@@ -12,17 +13,20 @@ RF24 radio(CE_PIN, CSN_PIN);
 
 // Logging to SD card
 static File logFile;
-static char logFilename[24];
+char logFilename[24];
 
 
 static uint32_t txSeq = 0; // Transmission sequence number
+static bool ackPayloadLoaded = false; // ground: a command frame is waiting in the ack FIFO
 
 // Call this on the sender Teensy on setup()
-void txInit(unsigned long retries = 3, unsigned long delayCycles = 5) {
+TVC_FLASHMEM void txInit(unsigned long retries, unsigned long delayCycles) {
     radio.begin();
     radio.setRetries(retries, delayCycles); // Set retries and delay
     radio.setPALevel(RF24_PA_LOW); // Set power level
     radio.setAutoAck(true); // Enable auto acknowledgment
+    radio.enableDynamicPayloads(); // needed for ack payloads (command uplink)
+    radio.enableAckPayload();
     radio.openWritingPipe(RADIO_PIPE); // Open writing pipe
     radio.stopListening(); // Set as transmitter (send only)
 
@@ -47,10 +51,12 @@ void txInit(unsigned long retries = 3, unsigned long delayCycles = 5) {
 }
 
 // Call this on the ground (receiver) Teensy on setup()
-void rxInit() {
+TVC_FLASHMEM void rxInit() {
     radio.begin();
     radio.setPALevel(RF24_PA_LOW); 
     radio.setAutoAck(true);
+    radio.enableDynamicPayloads(); // must match the rocket
+    radio.enableAckPayload(); // commands ride back on the ack
     radio.openReadingPipe(1, RADIO_PIPE); // Open reading pipe
     radio.startListening(); // Set as receiver (listen only)
 }
@@ -63,6 +69,7 @@ bool sendTelemetry(Telemetry& t) {
 
     radio.stopListening();
     bool ok = radio.write(&t, sizeof(t));
+    radio.flush_rx(); // ack payloads (commands) are only handled by sendTelemetryFrame
     // resume listening if needed
     // radio.startListening(); // Uncomment if switching back to RX mode
 
@@ -83,6 +90,81 @@ bool sendTelemetry(Telemetry& t) {
     return ok;
 }
 
+// Send the next frame from the telemetry multiplexer. Call every loop on the rocket,
+// the multiplexer decides what (if anything) is due. Returns true if a frame was sent and ACKed.
+// Any command the ground station put in the ACK is handed to `commands`.
+TVC_FASTRUN bool sendTelemetryFrame(Telemetry_Mux& mux, Command_Receiver *commands) {
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    uint8_t len = mux.build_frame((uint32_t)micros(), frame);
+    if (len == 0) return false;
+
+    bool ok = radio.write(frame, len);
+    mux.report_result(ok, radio.getARC()); // ARC = retransmits needed for this frame
+
+    // ack payloads arrive with the ACK itself, no switch to RX needed
+    while (radio.available()) {
+        uint8_t ack[32];
+        uint8_t ackLen = radio.getDynamicPayloadSize();
+        if (ackLen == 0 || ackLen > sizeof(ack)) {
+            // RF24 only flushes widths over 32; a 0 width (or a dead bus reading
+            // zeros) leaves available() true and would spin here forever
+            radio.flush_rx();
+            break;
+        }
+        radio.read(ack, ackLen);
+        if (commands) commands->on_ack_payload(ack, ackLen);
+    }
+    return ok;
+}
+
+struct FrameDispatch {
+    Command_Sender *commands;
+    Telemetry_Record_Fn onRecord;
+    void *ctx;
+    uint32_t now_us;
+};
+
+static void dispatchRecord(uint8_t frameSeq, uint8_t id, const uint8_t *payload, uint8_t len, void *ctx) {
+    FrameDispatch *d = (FrameDispatch *)ctx;
+    if (id == COMMAND_ACK_CHANNEL) d->commands->on_confirmation(payload, len, d->now_us);
+    if (d->onRecord) d->onRecord(frameSeq, id, payload, len, d->ctx);
+}
+
+// Call frequently on the ground (receiver) Teensy loop() when the rocket sends
+// multiplexer frames. Every record goes to onRecord. Command confirmations also go
+// to `commands`, and its pending command is kept loaded as the next ack payload.
+void processIncomingFrames(Command_Sender& commands, Telemetry_Record_Fn onRecord, void *ctx) {
+    while (radio.available()) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+        uint8_t len = radio.getDynamicPayloadSize();
+        if (len == 0 || len > sizeof(frame)) {
+            // RF24 only flushes widths over 32; a 0 width (or a dead bus reading
+            // zeros) leaves available() true and would spin here forever
+            radio.flush_rx();
+            break;
+        }
+        radio.read(frame, len);
+        ackPayloadLoaded = false; // the ACK for this frame carried the loaded payload
+
+        FrameDispatch d = {&commands, onRecord, ctx, (uint32_t)micros()};
+        Telemetry_Mux::parse_frame(frame, len, dispatchRecord, &d);
+    }
+
+    uint32_t now_us = (uint32_t)micros();
+    if (commands.check_timeout(now_us)) {
+        radio.flush_tx(); // rocket never picked it up, don't send it later
+        ackPayloadLoaded = false;
+    }
+    if (ackPayloadLoaded || !commands.busy()) return;
+
+    uint8_t cmd[32];
+    uint8_t cmdLen;
+    radio.flush_tx(); // keep at most one command in the ack FIFO
+    if (commands.next_ack_payload(now_us, cmd, cmdLen)) {
+        ackPayloadLoaded = radio.writeAckPayload(1, cmd, cmdLen);
+    }
+}
+
 // Call frequently on ground (receiver) Teensy loop() to process incoming packets.
 // Print to Serial if packet arrives.
 // TODO: update fields as needed
@@ -104,7 +186,7 @@ void processIncomingTelemetry() {
 }
 
 // Call this on shutdown to close log file
-void closeLogFile() {
+TVC_FLASHMEM void closeLogFile() {
     if (logFile) {
         logFile.close();
     }
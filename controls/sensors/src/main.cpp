@@ -5,7 +5,12 @@
 #include "sensors/imu.h"
 #include "sensors/barometer.h"
 #include "sensors/gps.h"
+#include "sensors/lidar.h"
 #include "motors/servo_drivers.h"
+#include "datalog/transceiver.h"
+#include "datalog/telemetry_channels.h"
+#include "util/cycle_counter.h"
+#include "util/memory_placement.h"
 
 
 /*
@@ -14,7 +19,7 @@ List of sensors:
     - BMP388 Barometric Pressure Sensor (i2c)
     - gy-gpsv3-neo 7m (uart 9600 baud by defualt)
     - ESP32 as transceiver (SPI)
-    - Benewake TFMini-S LiDAR (
+    - Benewake TFMini-S LiDAR (uart 460800 baud, 1 kHz frames)
 */
 
 
@@ -25,14 +30,176 @@ BMP388_Barometer bmp(BMP388_I2C_ADDRESS, BMP388_WIRE);
 // Fixed: Initialize GPS with Hardware Serial 1 (Serial1 on Pins 0/1) instead of the undefined macro
 GPS gps(Serial1, 9600);
 
+TFMiniS lidar(TFMINI_SERIAL, TFMINI_BAUD_RATE);
+
 
 Servo_Axis servo_y(SERVO_PIN_Y);
 Servo_Axis servo_z(SERVO_PIN_Z);
 Gimbal gimbal(servo_y, servo_z);
 
+// latest samples from the interrupt driven acquisition, with their capture
+// times converted to micros() while the cycle counter stamps are fresh
+Imu_Sample imu_sample;
+Baro_Sample baro_sample;
+uint32_t imu_capture_us = 0;
+uint32_t baro_capture_us = 0;
+uint32_t lidar_capture_us = 0;
+uint32_t last_print_ms = 0;
+
+// state reported on the status channel
+struct Flight_State {
+  bool armed;
+  float kp;
+  float kd;
+};
+Flight_State flight_state = {false, CONTROL_DEFAULT_KP, CONTROL_DEFAULT_KD};
+
+// sensor faults reported on the fault channel (TELEMETRY_FAULT_* bits)
+struct Fault_State {
+  uint8_t active;
+  uint8_t events; // raised since the last fault record went out
+  uint8_t last_events; // events in that record
+  uint32_t imu_ms, baro_ms, lidar_ms; // last new sample
+  uint32_t imu_read_failures, baro_read_failures, baro_release_failures; // driver totals already seen
+};
+Fault_State faults = {};
+
+// downlink, see datalog/telemetry_channels.h for the records
+Telemetry_Mux mux;
+
+static void fill_attitude(uint8_t *buf, void *) {
+  Attitude_Record r;
+  r.capture_us = imu_capture_us;
+  r.quat[0] = (int16_t)(imu_sample.quat.w() * TELEMETRY_QUAT_SCALE);
+  r.quat[1] = (int16_t)(imu_sample.quat.x() * TELEMETRY_QUAT_SCALE);
+  r.quat[2] = (int16_t)(imu_sample.quat.y() * TELEMETRY_QUAT_SCALE);
+  r.quat[3] = (int16_t)(imu_sample.quat.z() * TELEMETRY_QUAT_SCALE);
+  memcpy(buf, &r, sizeof(r));
+}
+
+static void fill_baro(uint8_t *buf, void *) {
+  Baro_Record r;
+  r.capture_us = baro_capture_us;
+  r.altitude = baro_sample.altitude;
+  r.temperature_c100 = (int16_t)(baro_sample.temperature * 100.0f);
+  memcpy(buf, &r, sizeof(r));
+}
+
+static void fill_lidar(uint8_t *buf, void *) {
+  Lidar_Record r;
+  r.capture_us = lidar_capture_us;
+  r.distance_cm = lidar.get_sample().distance_cm;
+  r.strength = lidar.get_sample().valid ? lidar.get_sample().strength : 0;
+  memcpy(buf, &r, sizeof(r));
+}
+
+static void fill_gps(uint8_t *buf, void *) {
+  Gps_Record r;
+  r.latitude_e7 = (int32_t)(gps.get_latitude() * 1e7f);
+  r.longitude_e7 = (int32_t)(gps.get_longitude() * 1e7f);
+  memcpy(buf, &r, sizeof(r));
+}
+
+static void fill_status(uint8_t *buf, void *) {
+  Status_Record r;
+  r.armed = flight_state.armed;
+  r.ms = millis();
+  r.kp = flight_state.kp;
+  r.kd = flight_state.kd;
+  memcpy(buf, &r, sizeof(r));
+}
+
+static uint16_t saturate_u16(uint32_t value) {
+  return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
+static void fill_fault(uint8_t *buf, void *) {
+  Fault_Record r;
+  r.ms = millis();
+  r.active = faults.active;
+  r.events = faults.events;
+  r.imu_read_failures = saturate_u16(faults.imu_read_failures);
+  r.baro_read_failures = saturate_u16(faults.baro_read_failures);
+  r.baro_release_failures = saturate_u16(faults.baro_release_failures);
+  faults.last_events = faults.events;
+  faults.events = 0;
+  memcpy(buf, &r, sizeof(r));
+}
+
+// Raises an event for every new driver failure and tracks sensors that went
+// quiet. A new fault, or one that clears, goes out in the next frame; an event
+// that was already in the last record (e.g. a bus that keeps failing) waits for
+// the regular 1 Hz record instead of sending a frame every loop.
+static void check_faults(uint32_t now_ms) {
+  uint8_t raised = 0;
+  if (bno.get_read_failures() != faults.imu_read_failures) raised |= TELEMETRY_FAULT_IMU_READ;
+  if (bmp.get_read_failures() != faults.baro_read_failures) raised |= TELEMETRY_FAULT_BARO_READ;
+  if (bmp.get_release_failures() != faults.baro_release_failures) raised |= TELEMETRY_FAULT_BARO_LATCH;
+  faults.imu_read_failures = bno.get_read_failures();
+  faults.baro_read_failures = bmp.get_read_failures();
+  faults.baro_release_failures = bmp.get_release_failures();
+
+  uint8_t active = 0;
+  if (now_ms - faults.imu_ms > BNO055_STALE_MS) active |= TELEMETRY_FAULT_IMU_STALE;
+  if (now_ms - faults.baro_ms > BMP388_STALE_MS) active |= TELEMETRY_FAULT_BARO_STALE;
+  if (now_ms - faults.lidar_ms > TFMINI_STALE_MS) active |= TELEMETRY_FAULT_LIDAR_LOST;
+  raised |= active & ~faults.active;
+
+  if ((raised & ~faults.last_events) || active != faults.active) mux.mark_urgent(TELEMETRY_CH_FAULT);
+  faults.active = active;
+  faults.events |= raised;
+}
+
+// uplink: commands arrive in the ACKs of our telemetry frames (datalog/command_link.h)
+static uint8_t handle_command(const Command& cmd, void *) {
+  switch (cmd.opcode) {
+  case COMMAND_ARM:
+    if (cmd.arg_len != 1) return COMMAND_STATUS_BAD_ARGS;
+    flight_state.armed = cmd.args[0] != 0;
+    mux.mark_urgent(TELEMETRY_CH_STATUS);
+    return COMMAND_STATUS_OK;
+
+  case COMMAND_SET_LOG_RATE: {
+    if (cmd.arg_len != 3) return COMMAND_STATUS_BAD_ARGS;
+    uint8_t id = cmd.args[0];
+    uint16_t rate_hz = (uint16_t)(cmd.args[1] | cmd.args[2] << 8);
+    // the confirmation channel is urgent-only, attitude and faults always run at full rate
+    if (id == COMMAND_ACK_CHANNEL || id == TELEMETRY_CH_ATTITUDE || id == TELEMETRY_CH_FAULT || !mux.get_channel(id)) {
+      return COMMAND_STATUS_REJECTED;
+    }
+    mux.set_rate(id, rate_hz);
+    return COMMAND_STATUS_OK;
+  }
+
+  case COMMAND_SET_GAINS: {
+    if (cmd.arg_len != 2 * sizeof(float)) return COMMAND_STATUS_BAD_ARGS;
+    float kp, kd;
+    memcpy(&kp, &cmd.args[0], sizeof(float));
+    memcpy(&kd, &cmd.args[4], sizeof(float));
+    if (!isfinite(kp) || !isfinite(kd) || kp < 0 || kd < 0) return COMMAND_STATUS_BAD_ARGS;
+    // no retuning in flight
+    if (flight_state.armed) return COMMAND_STATUS_REJECTED;
+    flight_state.kp = kp;
+    flight_state.kd = kd;
+    mux.mark_urgent(TELEMETRY_CH_STATUS);
+    return COMMAND_STATUS_OK;
+  }
+
+  case COMMAND_REQUEST_STATUS:
+    mux.mark_urgent(TELEMETRY_CH_STATUS);
+    return COMMAND_STATUS_OK;
+
+  default:
+    return COMMAND_STATUS_UNKNOWN;
+  }
+}
+
+Command_Receiver commands(handle_command, nullptr);
+
 
 
-void setup(void)
+// runs once, keep it out of ITCM (see util/memory_placement.h)
+TVC_FLASHMEM void setup(void)
 {
   //serial initialization
   Serial.begin(9600);
@@ -46,10 +213,28 @@ void setup(void)
   // sensor setups
   bno.setup();
   bmp.setup();
+
+  // sample on data-ready / fusion rate instead of polling every loop
+  bno.setup_timer(BNO055_SAMPLE_RATE_HZ);
+  bmp.setup_interrupt(BMP388_INT_PIN);
   
   // Initialize GPS Setup
   gps.setup();
 
+  lidar.setup(TFMINI_FRAME_RATE_HZ);
+
+  txInit();
+  mux.add_channel(TELEMETRY_CH_ATTITUDE, sizeof(Attitude_Record), 0, TELEMETRY_ATTITUDE_RATE_HZ, fill_attitude, nullptr);
+  mux.add_channel(TELEMETRY_CH_BARO, sizeof(Baro_Record), 1, TELEMETRY_BARO_RATE_HZ, fill_baro, nullptr);
+  mux.add_channel(TELEMETRY_CH_LIDAR, sizeof(Lidar_Record), 2, TELEMETRY_LIDAR_RATE_HZ, fill_lidar, nullptr);
+  mux.add_channel(TELEMETRY_CH_GPS, sizeof(Gps_Record), 2, TELEMETRY_GPS_RATE_HZ, fill_gps, nullptr);
+  mux.add_channel(TELEMETRY_CH_STATUS, sizeof(Status_Record), 1, TELEMETRY_STATUS_RATE_HZ, fill_status, nullptr);
+  mux.add_channel(TELEMETRY_CH_FAULT, sizeof(Fault_Record), 0, TELEMETRY_FAULT_RATE_HZ, fill_fault, nullptr);
+  commands.attach(mux);
+
+  // stale timeouts start now, not at boot
+  faults.imu_ms = faults.baro_ms = faults.lidar_ms = millis();
+
   // //servo wiggle
   // Serial.println("Wiggling servos...");
   // gimbal.drive_servos(0.0, 0.0);
@@ -78,18 +263,37 @@ void loop(void)
   // Update GPS
   gps.update();
 
-  Vector3 accel = bno.getAccel();
-  Vector3 gyro = bno.getGyro();
-  Vector3 mag = bno.getMagnetometer();
-  Vector3 linaccel = bno.getLinearAccel();
-  Quaternion quat = bno.getQuaternion();
-  float temperature = bmp.getTemperature();
-  float pressure = bmp.getPressure();
-  float altitude = bmp.getAltitude();
+  // IMU and barometer samples arrive at their own rates; each one carries
+  // the timestamp of its data-ready interrupt / sample tick
+  uint32_t now_ms = millis();
+  if (bno.poll_sample(imu_sample)) {
+    imu_capture_us = stamp_to_micros(imu_sample.capture_cycles);
+    faults.imu_ms = now_ms;
+  }
+  if (bmp.poll_sample(baro_sample)) {
+    baro_capture_us = stamp_to_micros(baro_sample.capture_cycles);
+    faults.baro_ms = now_ms;
+  }
+  if (lidar.update()) {
+    lidar_capture_us = stamp_to_micros(lidar.get_sample().capture_cycles);
+    faults.lidar_ms = now_ms;
+  }
+  check_faults(now_ms);
+
+  // the multiplexer decides what is due and what the airtime budget allows,
+  // ground commands come back in the ACK
+  sendTelemetryFrame(mux, &commands);
+
+  // print once a second for readability
+  if (millis() - last_print_ms < 1000) return;
+  last_print_ms = millis();
 
   // Add GPS data to the Serial print
   float gpsLat = gps.get_latitude();
-  float gpsAlt = gps.get_altitude_meters();
+
+  Vector3& accel = imu_sample.accel;
+  Vector3& gyro = imu_sample.gyro;
+  Quaternion& quat = imu_sample.quat;
 
   Serial.print("Accel (m/s^2): X="); Serial.print(accel.x());
   Serial.print(" Y="); Serial.print(accel.y());
@@ -98,10 +302,17 @@ void loop(void)
   Serial.print(" Y="); Serial.print(gyro.y());
   Serial.print(" Z="); Serial.print(gyro.z());
   Serial.print(" | Quaternion: W="); Serial.print(quat.w());
-  Serial.print(" altitude (m): "); Serial.print(altitude);
+  Serial.print(" altitude (m): "); Serial.print(baro_sample.altitude);
   Serial.print(" | GPS Lat: "); Serial.print(gpsLat, 6);
+  Serial.print(" | LiDAR (m): "); Serial.print(lidar.get_distance_meters());
+  Serial.print(lidar.get_sample().valid ? "" : " (weak)");
+  Serial.print(" | latency (us) imu: "); Serial.print(bno.get_latency().mean_us());
+  Serial.print("/"); Serial.print(bno.get_latency().max_us());
+  Serial.print(" baro: "); Serial.print(bmp.get_latency().mean_us());
+  Serial.print("/"); Serial.print(bmp.get_latency().max_us());
+  if (bmp.get_release_failures()) {
+    Serial.print(" | baro int release failures: "); Serial.print(bmp.get_release_failures());
+    Serial.print(" recovered: "); Serial.print(bmp.get_latch_recoveries());
+  }
   Serial.println();
-  
-
-  delay(1000); //delay for readability
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #include "motors/servo_drivers.h"
 #include "config.h"
+#include "util/memory_placement.h"
 #include <Arduino.h>
 
 #define DEFAULT_MINPOINT_US 500
@@ -8,88 +9,112 @@
 
 
 
-Servo_Axis::Servo_Axis(uint8_t servo_pin):
+template <typename Real>
+Servo_Axis_T<Real>::Servo_Axis_T(uint8_t servo_pin):
     servo(Servo())
-{   
+{
     this->servo_pin = servo_pin;
-    servo_offset_rads = 0.0;
-    ratio = 1.0;
+    servo_offset_rads = Real(0.0);
+    set_ratio(Real(1.0));
 
-    current_servo_angle_rads = 0.0;
+    current_servo_angle_rads = Real(0.0);
 
-    minpoint_us = DEFAULT_MINPOINT_US; // standard servo min pulse width
-    maxpoint_us = DEFAULT_MAXPOINT_US; // standard servo max pulse widtih
-    servo_range_rads = DEFAULT_SERVO_RANGE_RADS; // 180 degree range for standard servo
+    // standard servo min/max pulse width, 180 degree range
+    set_min_max_range(DEFAULT_MINPOINT_US, DEFAULT_MAXPOINT_US, Real(DEFAULT_SERVO_RANGE_RADS));
 }
 
-void Servo_Axis::attach(){
+template <typename Real>
+void Servo_Axis_T<Real>::attach(){
     servo.attach(servo_pin);
 }
 
-void Servo_Axis::set_offset(float offset_rads){
+template <typename Real>
+void Servo_Axis_T<Real>::set_offset(Real offset_rads){
     this->servo_offset_rads = offset_rads;
 }
-void Servo_Axis::set_ratio(float ratio){
+template <typename Real>
+void Servo_Axis_T<Real>::set_ratio(Real ratio){
     this->ratio = ratio;
+    this->inv_ratio = Real(1.0) / ratio;
 }
 
-void Servo_Axis::set_min_max_range(int minpoint_us, int maxpoint_us, float servo_range_rads){
+template <typename Real>
+void Servo_Axis_T<Real>::set_min_max_range(int minpoint_us, int maxpoint_us, Real servo_range_rads){
     this->minpoint_us = minpoint_us;
     this->maxpoint_us = maxpoint_us;
     this->servo_range_rads = servo_range_rads;
+    // precomputed here so the drive path has no divisions
+    this->half_range_rads = servo_range_rads * Real(0.5);
+    this->midpoint_us = num::from_int<Real>(minpoint_us + maxpoint_us) * Real(0.5);
+    this->us_per_rads = num::from_int<Real>(maxpoint_us - minpoint_us) / servo_range_rads;
 }
 
-void Servo_Axis::set_servo_angle(float angle_rads){
+template <typename Real>
+TVC_FASTRUN void Servo_Axis_T<Real>::set_servo_angle(Real angle_rads){
     //clip servo_angle to [-servo_range_rads/2, servo_range_rads/2]
-    float new_angle = fmax(fmin(angle_rads, servo_range_rads/2), -servo_range_rads/2);
-    current_servo_angle_rads = new_angle;
+    current_servo_angle_rads = num::clamp(angle_rads, -half_range_rads, half_range_rads);
 }
 
-void Servo_Axis::set_axis_angle(float angle_rads){
-    float servo_angle = angle_rads / ratio + servo_offset_rads;
+template <typename Real>
+TVC_FASTRUN void Servo_Axis_T<Real>::set_axis_angle(Real angle_rads){
+    Real servo_angle = angle_rads * inv_ratio + servo_offset_rads;
     set_servo_angle(servo_angle);
 }
 
-void Servo_Axis::drive_servo(){
-    // map the current_servo_angle_rads to pulse width
-    float us_per_rads = float(maxpoint_us - minpoint_us ) / servo_range_rads;
-    int pulse_width_us = int(minpoint_us + (current_servo_angle_rads) * us_per_rads);
+template <typename Real>
+TVC_FASTRUN void Servo_Axis_T<Real>::drive_servo(){
+    // map the current_servo_angle_rads to pulse width, 0 rads is the middle of the range
+    int pulse_width_us = num::to_int(midpoint_us + current_servo_angle_rads * us_per_rads);
+    // at the clip limit, Q16.16 rounding of us_per_rads can land 1 us outside the range
+    pulse_width_us = num::clamp(pulse_width_us, minpoint_us, maxpoint_us);
     servo.writeMicroseconds(pulse_width_us);
 }
 
 
 
-Gimbal::Gimbal(Servo_Axis& y_axis, Servo_Axis& z_axis) :
+template <typename Real>
+Gimbal_T<Real>::Gimbal_T(Servo_Axis_T<Real>& y_axis, Servo_Axis_T<Real>& z_axis) :
     axis_y(y_axis),
     axis_z(z_axis)
     {}
 
-Gimbal::Gimbal(int y_pin, int z_pin) : 
-    axis_y(Servo_Axis(y_pin)),
-    axis_z(Servo_Axis(z_pin))
+template <typename Real>
+Gimbal_T<Real>::Gimbal_T(int y_pin, int z_pin) :
+    axis_y(Servo_Axis_T<Real>(y_pin)),
+    axis_z(Servo_Axis_T<Real>(z_pin))
     {               }
 
-void Gimbal::set_angles(float angle_y_rads, float angle_z_rads){
+template <typename Real>
+TVC_FASTRUN void Gimbal_T<Real>::set_angles(Real angle_y_rads, Real angle_z_rads){
     axis_y.set_axis_angle(angle_y_rads);
     axis_z.set_axis_angle(angle_z_rads);
 }
 
-void Gimbal::drive_servos(){
+template <typename Real>
+TVC_FASTRUN void Gimbal_T<Real>::drive_servos(){
     axis_y.drive_servo();
     axis_z.drive_servo();
 }
 
-void Gimbal::drive_servos(float angle_y_rads, float angle_z_rads){
+template <typename Real>
+TVC_FASTRUN void Gimbal_T<Real>::drive_servos(Real angle_y_rads, Real angle_z_rads){
     set_angles(angle_y_rads, angle_z_rads);
     drive_servos();
 }
 
-void Gimbal::setup(){
-    axis_y.set_offset(SERVO_OFFSET_Y); axis_z.set_offset(SERVO_OFFSET_Z);
-    axis_y.set_ratio(GIMBAL_RATIO); axis_z.set_ratio(GIMBAL_RATIO);
-    axis_y.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, SERVO_RANGE_RADS);
-    axis_z.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, SERVO_RANGE_RADS);
+template <typename Real>
+TVC_FLASHMEM void Gimbal_T<Real>::setup(){
+    axis_y.set_offset(Real(SERVO_OFFSET_Y)); axis_z.set_offset(Real(SERVO_OFFSET_Z));
+    axis_y.set_ratio(Real(GIMBAL_RATIO)); axis_z.set_ratio(Real(GIMBAL_RATIO));
+    axis_y.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, Real(SERVO_RANGE_RADS));
+    axis_z.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, Real(SERVO_RANGE_RADS));
 
     axis_y.attach();
     axis_z.attach();
-}
\ No newline at end of file
+}
+
+// float for boards with an FPU (and host tools), Q16.16 for the teensy31
+template class Servo_Axis_T<float>;
+template class Servo_Axis_T<q16_16>;
+template class Gimbal_T<float>;
+template class Gimbal_T<q16_16>;
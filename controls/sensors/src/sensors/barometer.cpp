@@ -1,11 +1,17 @@
 #include "sensors/barometer.h"
+#include "util/memory_placement.h"
+#include "math/numeric.h"
 
 BMP388_Barometer::BMP388_Barometer(int i2cAddress, TwoWire *wire) : bmp(Adafruit_BMP3XX()) {
     this->i2cAddress = i2cAddress;
     this->wire = wire;
+    int_pin = -1;
+    release_failures = 0;
+    latch_recoveries = 0;
+    read_failures = 0;
 }
 
-void BMP388_Barometer::setup(){
+TVC_FLASHMEM void BMP388_Barometer::setup(){
     Serial.println("Attempting BMP388 connection...");
     if (!bmp.begin_I2C(i2cAddress, wire)){
         /* There was a problem detecting the BMP388 ... check your connections */
@@ -41,11 +47,146 @@ float BMP388_Barometer::getPressure() {
 }
 
 float BMP388_Barometer::getAltitude() {
-    if (!bmp.performReading()) {
+    float altitude;
+    if (!read_altitude(altitude)) {
         Serial.println("Failed to perform reading from BMP388");
         return NAN; // return Not-A-Number on failure
     }
-    return bmp.readAltitude(SEA_LEVEL_PRESSURE_HPA);
+    return altitude;
+}
+
+bool BMP388_Barometer::read_altitude(float& altitude) {
+    if (!bmp.performReading()) return false;
+    altitude = bmp.readAltitude(SEA_LEVEL_PRESSURE_HPA);
+    return true;
 }
 
 
+// ---- interrupt driven acquisition ----
+
+#define BMP388_REG_DATA 0x04       // press_xlsb .. temp_msb, 6 bytes
+#define BMP388_REG_INT_STATUS 0x11 // reading it clears the latched interrupt
+#define BMP388_REG_INT_CTRL 0x19
+#define BMP388_REG_PWR_CTRL 0x1B
+#define BMP388_REG_OSR 0x1C
+#define BMP388_REG_ODR 0x1D
+#define BMP388_REG_CALIB 0x31 // BMP388_CALIB_SIZE bytes of trimming coefficients
+
+#define BMP388_INT_DRDY_LATCHED_HIGH 0x46 // drdy_en | int_latch | active high, push-pull
+#define BMP388_PWR_NORMAL 0x33 // press_en | temp_en | normal mode
+#define BMP388_PWR_SLEEP 0x00
+#define BMP388_INT_RELEASE_ATTEMPTS 3
+#define BMP388_SEA_LEVEL_CENTI_PA ((uint32_t)(SEA_LEVEL_PRESSURE_HPA * 10000.0 + 0.5))
+
+BMP388_Barometer *BMP388_Barometer::isr_instance = nullptr;
+
+TVC_FLASHMEM void BMP388_Barometer::setup_interrupt(uint8_t int_pin, uint8_t output_data_rate) {
+    if (!read_calibration()) {
+        Serial.println("Failed to read BMP388 calibration");
+        return;
+    }
+
+    // registers can only be changed reliably in sleep mode
+    write_register(BMP388_REG_PWR_CTRL, BMP388_PWR_SLEEP);
+    write_register(BMP388_REG_OSR, (BMP388_TEMPERATURE_OVERSAMPLING << 3) | BMP388_PRESSURE_OVERSAMPLING);
+    write_register(BMP388_REG_ODR, output_data_rate);
+    write_register(BMP388_REG_INT_CTRL, BMP388_INT_DRDY_LATCHED_HIGH);
+
+    release_interrupt();
+
+    cycle_counter_init();
+    isr_instance = this;
+    this->int_pin = int_pin;
+    pinMode(int_pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(int_pin), on_data_ready, RISING);
+
+    write_register(BMP388_REG_PWR_CTRL, BMP388_PWR_NORMAL);
+    Serial.println("BMP388 data-ready interrupt enabled");
+}
+
+TVC_FASTRUN void BMP388_Barometer::on_data_ready() {
+    isr_instance->pending.push(cycle_count());
+}
+
+TVC_FASTRUN bool BMP388_Barometer::poll_sample(Baro_Sample& sample) {
+    uint32_t stamp, skipped;
+    bool stamped = true;
+    // the sensor only holds the latest conversion, older requests are stale
+    if (!pending.pop_latest(stamp, skipped)) {
+        // A latched pin that is still high never makes another rising edge, so a
+        // failed release would stop acquisition for good. Pick the sample up by
+        // level instead. Re-check the queue, the edge may have come after the pop.
+        if (int_pin < 0 || digitalRead(int_pin) == LOW) return false;
+        if (!pending.pop_latest(stamp, skipped)) {
+            stamp = cycle_count();
+            skipped = 0;
+            stamped = false;
+            latch_recoveries++;
+        }
+    }
+    latency.skipped += skipped;
+
+    uint8_t raw[6];
+    bool ok = read_registers(BMP388_REG_DATA, raw, sizeof(raw));
+    release_interrupt(); // on failure the pin stays high and the next poll retries
+    if (!ok) {
+        read_failures++;
+        return false;
+    }
+
+    uint32_t raw_pressure = (uint32_t)raw[2] << 16 | (uint32_t)raw[1] << 8 | raw[0];
+    uint32_t raw_temperature = (uint32_t)raw[5] << 16 | (uint32_t)raw[4] << 8 | raw[3];
+
+    sample.capture_cycles = stamp;
+#ifdef TVC_FIXED_POINT
+    // no FPU: integer compensation and a table for the altitude, only the unit conversions are float
+    int64_t t_lin;
+    int32_t temperature = comp.temperature_int(raw_temperature, t_lin);
+    uint32_t pressure = comp.pressure_int(raw_pressure, t_lin);
+    sample.temperature = temperature * 0.01f;
+    sample.pressure = pressure * 0.01f;
+    sample.altitude = BMP388_Compensation::altitude_mm(pressure, BMP388_SEA_LEVEL_CENTI_PA) * 0.001f;
+#else
+    sample.temperature = comp.temperature_float(raw_temperature);
+    sample.pressure = comp.pressure_float(raw_pressure, sample.temperature);
+    sample.altitude = BMP388_Compensation::altitude_float(sample.pressure, SEA_LEVEL_PRESSURE_HPA);
+#endif
+
+    if (stamped) latency.add(stamp);
+    return true;
+}
+
+// reading INT_STATUS clears the latched INT pin
+bool BMP388_Barometer::release_interrupt() {
+    uint8_t status;
+    for (uint8_t i = 0; i < BMP388_INT_RELEASE_ATTEMPTS; i++) {
+        if (read_registers(BMP388_REG_INT_STATUS, &status, 1)) return true;
+    }
+    release_failures++;
+    return false;
+}
+
+bool BMP388_Barometer::write_register(uint8_t reg, uint8_t value) {
+    wire->beginTransmission(i2cAddress);
+    wire->write(reg);
+    wire->write(value);
+    return wire->endTransmission() == 0;
+}
+
+bool BMP388_Barometer::read_registers(uint8_t reg, uint8_t *buf, uint8_t len) {
+    wire->beginTransmission(i2cAddress);
+    wire->write(reg);
+    if (wire->endTransmission(false) != 0) return false;
+    if (wire->requestFrom(i2cAddress, (int)len) != len) return false;
+    for (uint8_t i = 0; i < len; i++) {
+        buf[i] = wire->read();
+    }
+    return true;
+}
+
+bool BMP388_Barometer::read_calibration() {
+    uint8_t c[BMP388_CALIB_SIZE];
+    if (!read_registers(BMP388_REG_CALIB, c, sizeof(c))) return false;
+    comp.set_calibration(c);
+    return true;
+}
@@ -0,0 +1,141 @@
+#include "sensors/bmp388_compensation.h"
+#include <math.h>
+
+// Trimming coefficients and scale factors from the BMP388 datasheet, section 9.1
+void BMP388_Compensation::set_calibration(const uint8_t *c) {
+    par_t1 = (uint16_t)(c[1] << 8 | c[0]);
+    par_t2 = (uint16_t)(c[3] << 8 | c[2]);
+    par_t3 = (int8_t)c[4];
+    par_p1 = (int16_t)(c[6] << 8 | c[5]);
+    par_p2 = (int16_t)(c[8] << 8 | c[7]);
+    par_p3 = (int8_t)c[9];
+    par_p4 = (int8_t)c[10];
+    par_p5 = (uint16_t)(c[12] << 8 | c[11]);
+    par_p6 = (uint16_t)(c[14] << 8 | c[13]);
+    par_p7 = (int8_t)c[15];
+    par_p8 = (int8_t)c[16];
+    par_p9 = (int16_t)(c[18] << 8 | c[17]);
+    par_p10 = (int8_t)c[19];
+    par_p11 = (int8_t)c[20];
+
+    scaled.t1 = (float)par_t1 * 256.0f;                       // / 2^-8
+    scaled.t2 = (float)par_t2 / 1073741824.0f;                // / 2^30
+    scaled.t3 = (float)par_t3 / 281474976710656.0f;           // / 2^48
+    scaled.p1 = ((float)par_p1 - 16384.0f) / 1048576.0f;      // (- 2^14) / 2^20
+    scaled.p2 = ((float)par_p2 - 16384.0f) / 536870912.0f;    // (- 2^14) / 2^29
+    scaled.p3 = (float)par_p3 / 4294967296.0f;                // / 2^32
+    scaled.p4 = (float)par_p4 / 137438953472.0f;              // / 2^37
+    scaled.p5 = (float)par_p5 * 8.0f;                         // / 2^-3
+    scaled.p6 = (float)par_p6 / 64.0f;                        // / 2^6
+    scaled.p7 = (float)par_p7 / 256.0f;                       // / 2^8
+    scaled.p8 = (float)par_p8 / 32768.0f;                     // / 2^15
+    scaled.p9 = (float)par_p9 / 281474976710656.0f;           // / 2^48
+    scaled.p10 = (float)par_p10 / 281474976710656.0f;         // / 2^48
+    scaled.p11 = (float)par_p11 / 36893488147419103232.0f;    // / 2^65
+}
+
+// ---- float ----
+
+float BMP388_Compensation::temperature_float(uint32_t raw) const {
+    float d1 = (float)raw - scaled.t1;
+    float d2 = d1 * scaled.t2;
+    return d2 + d1 * d1 * scaled.t3;
+}
+
+float BMP388_Compensation::pressure_float(uint32_t raw, float t) const {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    float p = (float)raw;
+
+    float out1 = scaled.p5 + scaled.p6 * t + scaled.p7 * t2 + scaled.p8 * t3;
+    float out2 = p * (scaled.p1 + scaled.p2 * t + scaled.p3 * t2 + scaled.p4 * t3);
+    float out3 = p * p * (scaled.p9 + scaled.p10 * t) + p * p * p * scaled.p11;
+    return out1 + out2 + out3;
+}
+
+float BMP388_Compensation::altitude_float(float pressure_pa, float sea_level_hpa) {
+    return 44330.0f * (1.0f - powf(pressure_pa / 100.0f / sea_level_hpa, 0.1903f));
+}
+
+// ---- integer, same steps and scaling as the Bosch BMP3 API ----
+
+int32_t BMP388_Compensation::temperature_int(uint32_t raw, int64_t& t_lin) const {
+    int64_t d1 = (int64_t)raw - (int64_t)256 * par_t1;
+    int64_t d2 = (int64_t)par_t2 * d1;
+    int64_t d3 = d1 * d1;
+    int64_t d4 = d3 * par_t3;
+    t_lin = (d2 * 262144 + d4) / 4294967296;
+    return (int32_t)(t_lin * 25 / 16384);
+}
+
+uint32_t BMP388_Compensation::pressure_int(uint32_t raw, int64_t t_lin) const {
+    int64_t p = raw;
+
+    int64_t t2 = t_lin * t_lin;
+    int64_t t3 = t2 / 64 * t_lin / 256;
+    int64_t offset = (int64_t)par_p5 * 140737488355328 + (int64_t)par_p8 * t3 / 32 +
+                     (int64_t)par_p7 * t2 * 16 + (int64_t)par_p6 * t_lin * 4194304;
+    int64_t sensitivity = ((int64_t)par_p1 - 16384) * 70368744177664 + (int64_t)par_p4 * t3 / 32 +
+                          (int64_t)par_p3 * t2 * 4 + ((int64_t)par_p2 - 16384) * t_lin * 2097152;
+
+    int64_t out2 = sensitivity / 16777216 * p;
+    int64_t q = ((int64_t)par_p10 * t_lin + (int64_t)65536 * par_p9) * p / 8192;
+    // divided by 10 and multiplied back so p * q can't overflow
+    int64_t out3 = p * (q / 10) / 512 * 10;
+    int64_t out4 = (int64_t)par_p11 * (p * p) / 65536 * p / 128;
+
+    int64_t sum = offset / 4 + out2 + out3 + out4;
+    if (sum < 0) return 0;
+    return (uint32_t)((uint64_t)sum * 25 / 1099511627776);
+}
+
+// altitude in mm at pressure ratios 0.25, 0.25 + 1/256, ... 1.125 of sea level
+#define BMP388_ALTITUDE_TABLE_SIZE 225
+#define BMP388_ALTITUDE_TABLE_START (1 << 22) // 0.25 in Q24
+#define BMP388_ALTITUDE_TABLE_SHIFT 16        // 1/256 in Q24
+
+static const int32_t altitude_table_mm[BMP388_ALTITUDE_TABLE_SIZE] = {
+    10279326, 10178713, 10079345, 9981190, 9884213, 9788384, 9693674, 9600052,
+    9507493, 9415968, 9325453, 9235923, 9147354, 9059725, 8973011, 8887194,
+    8802251, 8718164, 8634913, 8552481, 8470848, 8389999, 8309916, 8230584,
+    8151986, 8074109, 7996937, 7920456, 7844652, 7769513, 7695025, 7621176,
+    7547954, 7475347, 7403343, 7331932, 7261103, 7190845, 7121147, 7052001,
+    6983397, 6915324, 6847774, 6780739, 6714208, 6648175, 6582630, 6517566,
+    6452975, 6388850, 6325182, 6261965, 6199191, 6136854, 6074947, 6013463,
+    5952396, 5891740, 5831488, 5771635, 5712175, 5653101, 5594410, 5536094,
+    5478148, 5420568, 5363349, 5306484, 5249970, 5193802, 5137974, 5082483,
+    5027324, 4972492, 4917983, 4863794, 4809919, 4756354, 4703096, 4650142,
+    4597486, 4545125, 4493056, 4441275, 4389778, 4338563, 4287625, 4236961,
+    4186568, 4136443, 4086582, 4036983, 3987642, 3938557, 3889724, 3841141,
+    3792805, 3744712, 3696861, 3649249, 3601872, 3554729, 3507816, 3461132,
+    3414673, 3368438, 3322424, 3276629, 3231050, 3185685, 3140532, 3095588,
+    3050852, 3006321, 2961994, 2917867, 2873940, 2830210, 2786675, 2743334,
+    2700183, 2657223, 2614449, 2571862, 2529459, 2487238, 2445197, 2403335,
+    2361651, 2320141, 2278806, 2237642, 2196649, 2155826, 2115169, 2074679,
+    2034353, 1994190, 1954188, 1914347, 1874664, 1835138, 1795768, 1756552,
+    1717490, 1678579, 1639819, 1601208, 1562745, 1524428, 1486257, 1448230,
+    1410346, 1372603, 1335002, 1297539, 1260215, 1223028, 1185977, 1149061,
+    1112279, 1075629, 1039111, 1002724, 966466, 930337, 894335, 858460,
+    822710, 787085, 751584, 716205, 680948, 645811, 610795, 575897,
+    541117, 506455, 471908, 437478, 403161, 368959, 334869, 300891,
+    267025, 233268, 199622, 166084, 132654, 99332, 66116, 33005,
+    0, -32901, -65699, -98394, -130986, -163478, -195869, -228160,
+    -260351, -292444, -324439, -356337, -388139, -419844, -451454, -482969,
+    -514391, -545719, -576954, -608097, -639149, -670109, -700979, -731760,
+    -762451, -793053, -823568, -853995, -884335, -914589, -944756, -974839,
+    -1004837,
+};
+
+int32_t BMP388_Compensation::altitude_mm(uint32_t pressure_centi_pa, uint32_t sea_level_centi_pa) {
+    // Q24 so the ratio's own rounding stays well under a centimetre
+    uint64_t ratio = ((uint64_t)pressure_centi_pa << 24) / sea_level_centi_pa;
+    if (ratio <= BMP388_ALTITUDE_TABLE_START) return altitude_table_mm[0];
+
+    uint64_t offset = ratio - BMP388_ALTITUDE_TABLE_START;
+    uint64_t i = offset >> BMP388_ALTITUDE_TABLE_SHIFT;
+    if (i >= BMP388_ALTITUDE_TABLE_SIZE - 1) return altitude_table_mm[BMP388_ALTITUDE_TABLE_SIZE - 1];
+
+    int32_t frac = (int32_t)(offset & ((1 << BMP388_ALTITUDE_TABLE_SHIFT) - 1));
+    int32_t step = altitude_table_mm[i + 1] - altitude_table_mm[i];
+    return altitude_table_mm[i] + (int32_t)((int64_t)step * frac / (1 << BMP388_ALTITUDE_TABLE_SHIFT));
+}
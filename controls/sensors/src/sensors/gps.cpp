@@ -1,11 +1,12 @@
 #include "sensors/gps.h"
+#include "util/memory_placement.h"
 
 GPS::GPS(HardwareSerial &gps_serial, int baud_rate) : gps(&gps_serial) {
     this->gps_ptr = &gps_serial;
     this->baud_rate = baud_rate;
 }
 
-void GPS::setup() {
+TVC_FLASHMEM void GPS::setup() {
     gps.begin(baud_rate);
     gps.sendCommand(PMTK_SET_NMEA_OUTPUT_RMCGGA);
     gps.sendCommand(PMTK_SET_NMEA_UPDATE_10HZ);
@@ -1,12 +1,19 @@
 #include "sensors/imu.h"
+#include "util/memory_placement.h"
 
 #define BNO055_I2C_DEFAULT_ADDRESS 0x28 // default i2c address for bno055
 
 
-BNO055_IMU::BNO055_IMU(int i2cAddress, TwoWire *wire) : bno(Adafruit_BNO055(-1, i2cAddress, wire)) {}
+BNO055_IMU::BNO055_IMU(int i2cAddress, TwoWire *wire) : bno(Adafruit_BNO055(-1, i2cAddress, wire)) {
+    this->i2cAddress = i2cAddress;
+    this->wire = wire;
+    memset(last_block, 0, sizeof(last_block));
+    duplicates = 0;
+    read_failures = 0;
+}
 
 
-void BNO055_IMU::setup(){
+TVC_FLASHMEM void BNO055_IMU::setup(){
     
     Serial.println("Attempting BNO055 connection...");
     if (!bno.begin()){
@@ -17,7 +24,7 @@ void BNO055_IMU::setup(){
     Serial.println("BNO055 connected... setting up...");
     
     bno.setExtCrystalUse(true);
-    bno.setMode(OPERATION_MODE_CONFIG);
+    bno.setMode(OPERATION_MODE_NDOF); // fusion mode, CONFIG mode outputs no data
     
     delay(25); // Allow sensor to stabilize
 
@@ -46,3 +53,76 @@ imu::Vector<3> BNO055_IMU::getLinearAccel() {
     return bno.getVector(Adafruit_BNO055::VECTOR_LINEARACCEL);
 }
 
+// ---- timed acquisition ----
+
+BNO055_IMU *BNO055_IMU::isr_instance = nullptr;
+
+TVC_FLASHMEM void BNO055_IMU::setup_timer(uint32_t rate_hz) {
+    cycle_counter_init();
+    isr_instance = this;
+    timer.begin(on_sample_tick, 1000000 / rate_hz);
+}
+
+TVC_FASTRUN void BNO055_IMU::on_sample_tick() {
+    isr_instance->pending.push(cycle_count());
+}
+
+#define BNO055_REG_DATA 0x08 // acc, mag, gyr, eul, qua: 0x08 .. 0x27 on page 0
+#define BNO055_ACCEL_OFFSET 0
+#define BNO055_GYRO_OFFSET 12
+#define BNO055_QUAT_OFFSET 24
+
+// scale factors for the default UNIT_SEL, same as Adafruit_BNO055
+#define BNO055_ACCEL_LSB_PER_MS2 100.0
+#define BNO055_GYRO_LSB_PER_DPS 16.0
+#define BNO055_QUAT_LSB (1 << 14)
+
+static int16_t le16(const uint8_t *p) { return (int16_t)((uint16_t)p[1] << 8 | p[0]); }
+
+TVC_FASTRUN bool BNO055_IMU::poll_sample(Imu_Sample& sample) {
+    uint32_t stamp, skipped;
+    if (!pending.pop_latest(stamp, skipped)) return false;
+    latency.skipped += skipped;
+
+    // one burst so quat, gyro and accel come from the same fusion update
+    uint8_t block[BNO055_DATA_BLOCK_SIZE];
+    if (!read_registers(BNO055_REG_DATA, block, sizeof(block))) {
+        read_failures++;
+        return false;
+    }
+
+    // The tick is not synchronized to the fusion output, drop it if nothing changed.
+    // Accel and gyro noise keeps the block moving even when the quaternion holds still.
+    if (memcmp(block, last_block, sizeof(block)) == 0) {
+        duplicates++;
+        return false;
+    }
+    memcpy(last_block, block, sizeof(block));
+
+    const uint8_t *a = block + BNO055_ACCEL_OFFSET;
+    const uint8_t *g = block + BNO055_GYRO_OFFSET;
+    const uint8_t *q = block + BNO055_QUAT_OFFSET;
+    const double quat_scale = 1.0 / BNO055_QUAT_LSB;
+
+    sample.capture_cycles = stamp;
+    sample.quat = imu::Quaternion(le16(q) * quat_scale, le16(q + 2) * quat_scale,
+                                  le16(q + 4) * quat_scale, le16(q + 6) * quat_scale);
+    sample.gyro = imu::Vector<3>(le16(g) / BNO055_GYRO_LSB_PER_DPS, le16(g + 2) / BNO055_GYRO_LSB_PER_DPS,
+                                 le16(g + 4) / BNO055_GYRO_LSB_PER_DPS);
+    sample.accel = imu::Vector<3>(le16(a) / BNO055_ACCEL_LSB_PER_MS2, le16(a + 2) / BNO055_ACCEL_LSB_PER_MS2,
+                                  le16(a + 4) / BNO055_ACCEL_LSB_PER_MS2);
+
+    latency.add(stamp);
+    return true;
+}
+
+bool BNO055_IMU::read_registers(uint8_t reg, uint8_t *buf, uint8_t len) {
+    wire->beginTransmission(i2cAddress);
+    wire->write(reg);
+    if (wire->endTransmission(false) != 0) return false;
+    if (wire->requestFrom(i2cAddress, (int)len) != len) return false;
+    for (uint8_t i = 0; i < len; i++) {
+        buf[i] = wire->read();
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#include "sensors/lidar.h"
+#include "util/cycle_counter.h"
+#include "util/memory_placement.h"
+
+#define TFMINI_CMD_HEADER 0x5A
+#define TFMINI_CMD_FRAME_RATE 0x03
+#define TFMINI_CMD_BAUD_RATE 0x06
+
+#define TFMINI_DRAIN_CHUNK 64
+
+// Extra RX buffer for the serial port, the default one overflows in under 10 ms at 1 kHz
+static uint8_t lidar_rx_buffer[TFMINI_RX_BUFFER_SIZE] TVC_DMAMEM;
+
+TFMiniS::TFMiniS(HardwareSerial &lidar_serial, uint32_t baud_rate) {
+    this->lidar_ptr = &lidar_serial;
+    this->baud_rate = baud_rate;
+    cycles_per_byte = 0;
+    memset(&sample, 0, sizeof(sample));
+}
+
+TVC_FLASHMEM void TFMiniS::setup(uint16_t frame_rate_hz) {
+    Serial.println("Setting up TFMini-S...");
+    cycle_counter_init();
+    lidar_ptr->addMemoryForRead(lidar_rx_buffer, sizeof(lidar_rx_buffer));
+
+    // 1 kHz of 9-byte frames needs at least 90 kbaud, so switch up first
+    lidar_ptr->begin(TFMINI_DEFAULT_BAUD_RATE);
+    uint8_t set_baud[8] = {TFMINI_CMD_HEADER, 8, TFMINI_CMD_BAUD_RATE,
+                           (uint8_t)baud_rate, (uint8_t)(baud_rate >> 8),
+                           (uint8_t)(baud_rate >> 16), (uint8_t)(baud_rate >> 24), 0};
+    send_command(set_baud, sizeof(set_baud));
+    lidar_ptr->flush();
+    delay(10);
+    lidar_ptr->begin(baud_rate);
+
+    uint8_t set_rate[6] = {TFMINI_CMD_HEADER, 6, TFMINI_CMD_FRAME_RATE,
+                           (uint8_t)frame_rate_hz, (uint8_t)(frame_rate_hz >> 8), 0};
+    send_command(set_rate, sizeof(set_rate));
+    lidar_ptr->flush();
+
+    // 10 bits on the wire per byte (8N1)
+    cycles_per_byte = (uint32_t)((uint64_t)CYCLE_COUNTER_HZ * 10 / baud_rate);
+
+    // drop the command responses and anything received at the old baud rate
+    delay(10);
+    while (lidar_ptr->available()) lidar_ptr->read();
+    parser.reset();
+    Serial.println("TFMini-S Initialized");
+}
+
+void TFMiniS::send_command(const uint8_t *cmd, uint8_t len) {
+    // last byte is the checksum: low byte of the sum of the others
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < len - 1; i++) sum += cmd[i];
+    lidar_ptr->write(cmd, len - 1);
+    lidar_ptr->write(sum);
+}
+
+TVC_FASTRUN bool TFMiniS::update() {
+    uint8_t chunk[TFMINI_DRAIN_CHUNK];
+    TFMini_Frame frames[TFMINI_DRAIN_CHUNK / TFMINI_FRAME_SIZE + 1];
+    bool got_frame = false;
+
+    int available;
+    while ((available = lidar_ptr->available()) > 0) {
+        int len = lidar_ptr->readBytes(chunk, available < TFMINI_DRAIN_CHUNK ? available : TFMINI_DRAIN_CHUNK);
+        uint32_t now = cycle_count();
+        int remaining = lidar_ptr->available();
+        size_t found = parser.parse(chunk, len, frames, sizeof(frames) / sizeof(frames[0]));
+        if (found == 0) continue;
+
+        // only the newest frame is kept; back-date it by the bytes that arrived after it,
+        // both in this chunk and still waiting in the RX buffer
+        const TFMini_Frame& frame = frames[found - 1];
+        uint32_t bytes_after = (uint32_t)(len - frame.end_offset) + remaining;
+        sample.capture_cycles = now - bytes_after * cycles_per_byte;
+        sample.distance_cm = frame.distance_cm;
+        sample.strength = frame.strength;
+        sample.temperature = frame.temperature_raw / 8.0f - 256.0f;
+        sample.valid = frame.strength >= TFMINI_MIN_STRENGTH && frame.strength != 65535;
+        got_frame = true;
+    }
+    return got_frame;
+}
@@ -0,0 +1,65 @@
+#include "sensors/tfmini_parser.h"
+#include "util/memory_placement.h"
+#include <string.h>
+
+TFMini_Frame_Parser::TFMini_Frame_Parser() {
+    reset();
+}
+
+void TFMini_Frame_Parser::reset() {
+    count = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+TVC_FASTRUN bool TFMini_Frame_Parser::push(uint8_t byte, TFMini_Frame& frame) {
+    // hunting for the two header bytes
+    if (count < 2 && byte != TFMINI_HEADER) {
+        stats.bytes_discarded += count + 1;
+        count = 0;
+        return false;
+    }
+
+    buf[count++] = byte;
+    if (count < TFMINI_FRAME_SIZE) return false;
+
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < TFMINI_FRAME_SIZE - 1; i++) sum += buf[i];
+    if (sum != buf[TFMINI_FRAME_SIZE - 1]) {
+        stats.checksum_errors++;
+        resync();
+        return false;
+    }
+
+    frame.distance_cm = (uint16_t)(buf[3] << 8 | buf[2]);
+    frame.strength = (uint16_t)(buf[5] << 8 | buf[4]);
+    frame.temperature_raw = (uint16_t)(buf[7] << 8 | buf[6]);
+    stats.frames++;
+    count = 0;
+    return true;
+}
+
+// Drops the rejected frame's first header byte and restarts from the next
+// 0x59 0x59 pair in what is left (or a trailing 0x59 that may start one).
+void TFMini_Frame_Parser::resync() {
+    uint8_t start = 1;
+    for (; start < TFMINI_FRAME_SIZE; start++) {
+        if (buf[start] != TFMINI_HEADER) continue;
+        if (start == TFMINI_FRAME_SIZE - 1 || buf[start + 1] == TFMINI_HEADER) break;
+    }
+    stats.bytes_discarded += start;
+    count = TFMINI_FRAME_SIZE - start;
+    memmove(buf, &buf[start], count);
+}
+
+TVC_FASTRUN size_t TFMini_Frame_Parser::parse(const uint8_t *data, size_t len, TFMini_Frame *frames, size_t max_frames) {
+    size_t found = 0;
+    TFMini_Frame frame;
+    for (size_t i = 0; i < len; i++) {
+        if (!push(data[i], frame)) continue;
+        if (found < max_frames) {
+            frame.end_offset = (uint16_t)(i + 1);
+            frames[found++] = frame;
+        }
+    }
+    return found;
+}
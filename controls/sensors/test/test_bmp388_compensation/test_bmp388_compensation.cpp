@@ -0,0 +1,76 @@
+// Host tests for sensors/bmp388_compensation.h: the integer (teensy31) path against the float one.
+//     pio test -e native_test -f test_bmp388_compensation
+
+#include <unity.h>
+#include <math.h>
+#include "sensors/bmp388_compensation.h"
+
+#define TEST_SEA_LEVEL_HPA 1013.25f
+#define TEST_SEA_LEVEL_CENTI_PA 10132500
+
+void setUp() {}
+void tearDown() {}
+
+// plausible trimming bytes: t1 27733, t2 19153, t3 -7, p1 1543, p2 -2500, p3 4, p4 0,
+// p5 24000, p6 28000, p7 3, p8 -6, p9 16000, p10 4, p11 -60
+static const uint8_t calib[BMP388_CALIB_SIZE] = {
+    0x55, 0x6C, 0xD1, 0x4A, 0xF9, 0x07, 0x06, 0x3C, 0xF6, 0x04, 0x00,
+    0xC0, 0x5D, 0x60, 0x6D, 0x03, 0xFA, 0x80, 0x3E, 0x04, 0xC4,
+};
+
+void test_temperature_int_matches_float() {
+    BMP388_Compensation comp;
+    comp.set_calibration(calib);
+    for (uint32_t raw = 7000000; raw < 9500000; raw += 10000) {
+        int64_t t_lin;
+        int32_t t = comp.temperature_int(raw, t_lin);
+        TEST_ASSERT_FLOAT_WITHIN(0.011f, comp.temperature_float(raw), t * 0.01f);
+    }
+}
+
+// over the whole flight envelope: -2 .. 43 C and 68 .. 110 kPa with these coefficients
+void test_pressure_int_matches_float() {
+    BMP388_Compensation comp;
+    comp.set_calibration(calib);
+    uint32_t checked = 0;
+    for (uint32_t raw_t = 7000000; raw_t < 9500000; raw_t += 50000) {
+        int64_t t_lin;
+        comp.temperature_int(raw_t, t_lin);
+        float t = comp.temperature_float(raw_t);
+        for (uint32_t raw_p = 4000000; raw_p < 9000000; raw_p += 20000) {
+            float expected = comp.pressure_float(raw_p, t);
+            if (expected < 30000.0f || expected > 110000.0f) continue;
+            TEST_ASSERT_FLOAT_WITHIN(0.1f, expected, comp.pressure_int(raw_p, t_lin) * 0.01f);
+            checked++;
+        }
+    }
+    TEST_ASSERT_TRUE(checked > 1000);
+}
+
+void test_altitude_table_matches_formula() {
+    for (uint32_t centi_pa = 3000000; centi_pa <= 11000000; centi_pa += 701) {
+        float expected = BMP388_Compensation::altitude_float(centi_pa * 0.01f, TEST_SEA_LEVEL_HPA);
+        int32_t mm = BMP388_Compensation::altitude_mm(centi_pa, TEST_SEA_LEVEL_CENTI_PA);
+        TEST_ASSERT_FLOAT_WITHIN(0.15f, expected, mm * 0.001f);
+    }
+    TEST_ASSERT_EQUAL_INT32(0, BMP388_Compensation::altitude_mm(TEST_SEA_LEVEL_CENTI_PA, TEST_SEA_LEVEL_CENTI_PA));
+}
+
+// outside the table the result pins to its ends instead of extrapolating
+void test_altitude_table_clamps() {
+    int32_t top = BMP388_Compensation::altitude_mm(2000000, TEST_SEA_LEVEL_CENTI_PA);
+    int32_t bottom = BMP388_Compensation::altitude_mm(12000000, TEST_SEA_LEVEL_CENTI_PA);
+    TEST_ASSERT_EQUAL_INT32(top, BMP388_Compensation::altitude_mm(0, TEST_SEA_LEVEL_CENTI_PA));
+    TEST_ASSERT_EQUAL_INT32(bottom, BMP388_Compensation::altitude_mm(UINT32_MAX, TEST_SEA_LEVEL_CENTI_PA));
+    TEST_ASSERT_TRUE(top > 10000000);
+    TEST_ASSERT_TRUE(bottom < -1000000);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_temperature_int_matches_float);
+    RUN_TEST(test_pressure_int_matches_float);
+    RUN_TEST(test_altitude_table_matches_formula);
+    RUN_TEST(test_altitude_table_clamps);
+    return UNITY_END();
+}
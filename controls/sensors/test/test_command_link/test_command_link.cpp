@@ -0,0 +1,155 @@
+// Host tests for datalog/command_link.h: framing, duplicate handling and confirmations.
+//     pio test -e native_test -f test_command_link
+
+#include <unity.h>
+#include <string.h>
+#include "datalog/command_link.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Handler_Log {
+    uint8_t opcodes[16];
+    uint8_t count;
+};
+
+static uint8_t log_handler(const Command& cmd, void *ctx) {
+    Handler_Log *log = (Handler_Log *)ctx;
+    if (log->count < sizeof(log->opcodes)) log->opcodes[log->count++] = cmd.opcode;
+    return COMMAND_STATUS_OK;
+}
+
+// Moves the sender's pending frame to the rocket and the rocket's confirmation
+// record back, like one telemetry frame with an ack payload. Returns true if
+// the sender took it as confirmation of its command.
+static bool exchange(Command_Sender& sender, Command_Receiver& receiver, Telemetry_Mux& mux, uint32_t now_us) {
+    uint8_t frame[32];
+    uint8_t len;
+    if (!sender.next_ack_payload(now_us, frame, len)) return false;
+    receiver.on_ack_payload(frame, len);
+
+    uint8_t telemetry[TELEMETRY_FRAME_SIZE];
+    uint8_t telemetry_len = mux.build_frame(now_us, telemetry);
+    mux.report_result(true, 0);
+
+    struct Ctx { Command_Sender *sender; uint32_t now_us; bool confirmed; } ctx = {&sender, now_us, false};
+    Telemetry_Mux::parse_frame(telemetry, telemetry_len, [](uint8_t, uint8_t id, const uint8_t *payload, uint8_t plen, void *c) {
+        Ctx *x = (Ctx *)c;
+        if (id == COMMAND_ACK_CHANNEL) x->confirmed |= x->sender->on_confirmation(payload, plen, x->now_us);
+    }, &ctx);
+    return ctx.confirmed;
+}
+
+void test_encode_decode_roundtrip() {
+    Command cmd;
+    cmd.session = 0xBEEF;
+    cmd.seq = 42;
+    cmd.opcode = COMMAND_SET_GAINS;
+    cmd.arg_len = COMMAND_MAX_ARGS;
+    for (uint8_t i = 0; i < COMMAND_MAX_ARGS; i++) cmd.args[i] = i;
+
+    uint8_t frame[32];
+    uint8_t len = encode_command(cmd, frame);
+    TEST_ASSERT_EQUAL_UINT8(32, len);
+
+    Command out;
+    TEST_ASSERT_TRUE(decode_command(frame, len, out));
+    TEST_ASSERT_EQUAL_UINT16(0xBEEF, out.session);
+    TEST_ASSERT_EQUAL_UINT8(42, out.seq);
+    TEST_ASSERT_EQUAL_UINT8(COMMAND_SET_GAINS, out.opcode);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(cmd.args, out.args, COMMAND_MAX_ARGS);
+
+    frame[7] ^= 0x01;
+    TEST_ASSERT_FALSE(decode_command(frame, len, out));
+}
+
+void test_duplicates_run_once() {
+    Handler_Log log = {{0}, 0};
+    Telemetry_Mux mux(1000000);
+    Command_Receiver receiver(log_handler, &log);
+    TEST_ASSERT_TRUE(receiver.attach(mux));
+    Command_Sender sender(7);
+
+    uint8_t rate_args[3] = {1, 10, 0};
+    TEST_ASSERT_TRUE(sender.send(COMMAND_SET_LOG_RATE, rate_args, sizeof(rate_args)));
+
+    uint8_t frame[32];
+    uint8_t len;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(sender.next_ack_payload(1000 + i, frame, len));
+        receiver.on_ack_payload(frame, len);
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, log.count);
+    TEST_ASSERT_EQUAL_UINT32(2, receiver.get_duplicates());
+}
+
+// The ground station reboots after the rocket ran seq 1. The new sender starts
+// at seq 1 again; its ARM must run, and the old confirmation still in the
+// rocket's status record must not confirm it.
+void test_ground_reboot_does_not_drop_arm() {
+    Handler_Log log = {{0}, 0};
+    Telemetry_Mux mux(1000000);
+    Command_Receiver receiver(log_handler, &log);
+    TEST_ASSERT_TRUE(receiver.attach(mux));
+
+    Command_Sender before_reboot(1);
+    uint8_t rate_args[3] = {1, 10, 0};
+    TEST_ASSERT_TRUE(before_reboot.send(COMMAND_SET_LOG_RATE, rate_args, sizeof(rate_args)));
+    TEST_ASSERT_TRUE(exchange(before_reboot, receiver, mux, 1000));
+    TEST_ASSERT_EQUAL_UINT8(1, log.count);
+
+    // the rocket's confirmation record still holds {session 1, seq 1, SET_LOG_RATE, OK}
+    Command_Sender after_reboot(2);
+    uint8_t stale_ack[COMMAND_ACK_SIZE] = {1, 0, 1, COMMAND_SET_LOG_RATE, COMMAND_STATUS_OK};
+    uint8_t arm_args[1] = {1};
+    TEST_ASSERT_TRUE(after_reboot.send(COMMAND_ARM, arm_args, sizeof(arm_args)));
+    uint8_t frame[32];
+    uint8_t len;
+    TEST_ASSERT_TRUE(after_reboot.next_ack_payload(2000, frame, len));
+    TEST_ASSERT_FALSE(after_reboot.on_confirmation(stale_ack, sizeof(stale_ack), 2100));
+    TEST_ASSERT_TRUE(after_reboot.busy());
+
+    receiver.on_ack_payload(frame, len);
+    TEST_ASSERT_EQUAL_UINT8(2, log.count);
+    TEST_ASSERT_EQUAL_UINT8(COMMAND_ARM, log.opcodes[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, receiver.get_duplicates());
+}
+
+// same session and seq but another opcode (e.g. a confirmation from a cancelled command)
+void test_confirmation_checks_opcode() {
+    Command_Sender sender(5);
+    uint8_t arm_args[1] = {1};
+    TEST_ASSERT_TRUE(sender.send(COMMAND_ARM, arm_args, sizeof(arm_args)));
+    uint8_t frame[32];
+    uint8_t len;
+    TEST_ASSERT_TRUE(sender.next_ack_payload(0, frame, len));
+
+    uint8_t wrong_opcode[COMMAND_ACK_SIZE] = {5, 0, 1, COMMAND_REQUEST_STATUS, COMMAND_STATUS_OK};
+    TEST_ASSERT_FALSE(sender.on_confirmation(wrong_opcode, sizeof(wrong_opcode), 100));
+    uint8_t right[COMMAND_ACK_SIZE] = {5, 0, 1, COMMAND_ARM, COMMAND_STATUS_REJECTED};
+    TEST_ASSERT_TRUE(sender.on_confirmation(right, sizeof(right), 100));
+    TEST_ASSERT_EQUAL_UINT8(COMMAND_STATUS_REJECTED, sender.get_last_status());
+    TEST_ASSERT_EQUAL_UINT32(100, sender.get_last_rtt_us());
+}
+
+void test_timeout() {
+    Command_Sender sender(9);
+    TEST_ASSERT_TRUE(sender.send(COMMAND_REQUEST_STATUS, nullptr, 0));
+    uint8_t frame[32];
+    uint8_t len;
+    TEST_ASSERT_TRUE(sender.next_ack_payload(0, frame, len));
+    TEST_ASSERT_FALSE(sender.check_timeout(COMMAND_TIMEOUT_US));
+    TEST_ASSERT_TRUE(sender.check_timeout(COMMAND_TIMEOUT_US + 1));
+    TEST_ASSERT_FALSE(sender.busy());
+    TEST_ASSERT_EQUAL_UINT32(1, sender.get_timeouts());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_encode_decode_roundtrip);
+    RUN_TEST(test_duplicates_run_once);
+    RUN_TEST(test_ground_reboot_does_not_drop_arm);
+    RUN_TEST(test_confirmation_checks_opcode);
+    RUN_TEST(test_timeout);
+    return UNITY_END();
+}
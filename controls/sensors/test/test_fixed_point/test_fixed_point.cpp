@@ -0,0 +1,157 @@
+// Host tests for math/fixed_point.h and the fixed-point servo mapping.
+//     pio test -e native_test -f test_fixed_point
+
+#include <unity.h>
+#include <math.h>
+#include <Servo.h>
+#include "math/fixed_point.h"
+#include "math/numeric.h"
+#include "motors/servo_drivers.h"
+
+void setUp() {}
+void tearDown() {}
+
+// ---- saturation ----
+
+void test_add_sub_saturate() {
+    TEST_ASSERT_TRUE(q16_16::max_value() + q16_16::epsilon() == q16_16::max_value());
+    TEST_ASSERT_TRUE(q16_16::min_value() - q16_16::epsilon() == q16_16::min_value());
+    TEST_ASSERT_TRUE(q16_16(30000.0) + q16_16(30000.0) == q16_16::max_value());
+    TEST_ASSERT_TRUE(q16_16(-30000.0) - q16_16(30000.0) == q16_16::min_value());
+    // -INT32_MIN doesn't fit, it must pin instead of staying negative
+    TEST_ASSERT_TRUE(-q16_16::min_value() == q16_16::max_value());
+}
+
+void test_mul_div_saturate() {
+    TEST_ASSERT_TRUE(q16_16(300.0) * q16_16(300.0) == q16_16::max_value());
+    TEST_ASSERT_TRUE(q16_16(-300.0) * q16_16(300.0) == q16_16::min_value());
+    TEST_ASSERT_TRUE(q16_16(1.0) / q16_16(0.0) == q16_16::max_value());
+    TEST_ASSERT_TRUE(q16_16(-1.0) / q16_16(0.0) == q16_16::min_value());
+    TEST_ASSERT_TRUE(q16_16(20000.0) / q16_16(0.5) == q16_16::max_value());
+}
+
+void test_q1_31_range() {
+    // 1.0 is just outside [-1, 1), -1.0 is exact
+    TEST_ASSERT_TRUE(q1_31(1.0) == q1_31::max_value());
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q1_31(-1.0).get_raw());
+    TEST_ASSERT_TRUE(q1_31(-1.0) * q1_31(-1.0) == q1_31::max_value());
+    TEST_ASSERT_TRUE(q1_31(0.5) * q1_31(0.5) == q1_31(0.25));
+    TEST_ASSERT_TRUE(q1_31(0.75) + q1_31(0.75) == q1_31::max_value());
+}
+
+// ---- rounding ----
+
+void test_from_double_rounds_to_nearest() {
+    double eps = 1.0 / 65536.0;
+    TEST_ASSERT_EQUAL_INT32(1, q16_16(0.5 * eps).get_raw());
+    TEST_ASSERT_EQUAL_INT32(-1, q16_16(-0.5 * eps).get_raw());
+    TEST_ASSERT_EQUAL_INT32(0, q16_16(0.49 * eps).get_raw());
+    TEST_ASSERT_EQUAL_INT32(2, q16_16(1.6 * eps).get_raw());
+}
+
+void test_mul_rounds_to_nearest() {
+    // 3 * 0.5 = 1.5 raw units, rounds up to 2
+    TEST_ASSERT_EQUAL_INT32(2, (q16_16::from_raw(3) * q16_16(0.5)).get_raw());
+    TEST_ASSERT_EQUAL_INT32(1, (q16_16::from_raw(3) * q16_16(0.25)).get_raw());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.999f * 0.001f, (q16_16(0.999) * q16_16(0.001)).to_float());
+}
+
+void test_to_int_truncates_toward_zero() {
+    TEST_ASSERT_EQUAL_INT32(2, q16_16(2.75).to_int());
+    TEST_ASSERT_EQUAL_INT32(-2, q16_16(-2.75).to_int());
+    TEST_ASSERT_EQUAL_INT32(0, q16_16(-0.5).to_int());
+    TEST_ASSERT_EQUAL_INT32(-3, q16_16(-3.0).to_int());
+    TEST_ASSERT_EQUAL_INT32(32767, q16_16::max_value().to_int());
+    TEST_ASSERT_EQUAL_INT32(-32768, q16_16::min_value().to_int());
+    TEST_ASSERT_EQUAL_INT32(0, q1_31(0.999).to_int());
+}
+
+void test_rescale_between_formats() {
+    TEST_ASSERT_TRUE(q16_16(q1_31(0.5)) == q16_16(0.5));
+    TEST_ASSERT_TRUE(q1_31(q16_16(-0.25)) == q1_31(-0.25));
+    TEST_ASSERT_TRUE(q1_31(q16_16(3.0)) == q1_31::max_value());
+}
+
+// ---- run-time float conversion ----
+
+template <typename T>
+static void check_from_float_matches_double(float value) {
+    TEST_ASSERT_EQUAL_INT32(T(double(value)).get_raw(), T::from_float(value).get_raw());
+}
+
+void test_from_float_matches_from_double() {
+    static const float values[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 1.5f, 0.1f, -0.1f, 3.14159265f,
+                                   -2.71828f, 1e-6f, -1e-6f, 7.62939453125e-6f, 1e-30f, 32767.99f,
+                                   32768.0f, -32768.0f, -40000.0f, 1e30f, -1e30f, 0.999999f, -0.999999f};
+    for (float v : values) {
+        check_from_float_matches_double<q16_16>(v);
+        check_from_float_matches_double<q1_31>(v);
+    }
+    // dense sweep over the servo command range
+    for (int i = -20000; i <= 20000; i++) {
+        float v = i * 1.2345e-4f;
+        check_from_float_matches_double<q16_16>(v);
+        check_from_float_matches_double<q1_31>(v);
+    }
+}
+
+void test_from_float_special_values() {
+    TEST_ASSERT_TRUE(q16_16::from_float(INFINITY) == q16_16::max_value());
+    TEST_ASSERT_TRUE(q16_16::from_float(-INFINITY) == q16_16::min_value());
+    TEST_ASSERT_EQUAL_INT32(0, q16_16::from_float(NAN).get_raw());
+    TEST_ASSERT_TRUE(num::from_float<q16_16>(0.25f) == q16_16(0.25));
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.25f, num::from_float<float>(0.25f));
+}
+
+// ---- servo mapping, fixed vs float ----
+
+#define TEST_SERVO_PIN_FLOAT 2
+#define TEST_SERVO_PIN_FIXED 3
+
+void test_servo_fixed_matches_float() {
+    Servo_Axis_T<float> axis_float(TEST_SERVO_PIN_FLOAT);
+    Servo_Axis_T<q16_16> axis_fixed(TEST_SERVO_PIN_FIXED);
+    axis_float.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, float(SERVO_RANGE_RADS));
+    axis_fixed.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, q16_16(SERVO_RANGE_RADS));
+    axis_float.set_ratio(1.5f);
+    axis_fixed.set_ratio(q16_16(1.5));
+    axis_float.attach();
+    axis_fixed.attach();
+
+    // past both ends of the range, so the clip is covered too
+    for (int i = -2500; i <= 2500; i++) {
+        float angle = i * 1e-3f;
+        axis_float.set_axis_angle(angle);
+        axis_fixed.set_axis_angle(q16_16::from_float(angle));
+        axis_float.drive_servo();
+        axis_fixed.drive_servo();
+        TEST_ASSERT_INT_WITHIN(1, host_servo_pulse_us(TEST_SERVO_PIN_FLOAT), host_servo_pulse_us(TEST_SERVO_PIN_FIXED));
+        TEST_ASSERT_TRUE(host_servo_pulse_us(TEST_SERVO_PIN_FIXED) >= SERVO_MIN_PULSE_WIDTH);
+        TEST_ASSERT_TRUE(host_servo_pulse_us(TEST_SERVO_PIN_FIXED) <= SERVO_MAX_PULSE_WIDTH);
+    }
+}
+
+void test_servo_zero_is_center() {
+    Servo_Axis_T<q16_16> axis(TEST_SERVO_PIN_FIXED);
+    axis.set_min_max_range(SERVO_MIN_PULSE_WIDTH, SERVO_MAX_PULSE_WIDTH, q16_16(SERVO_RANGE_RADS));
+    axis.attach();
+    axis.set_axis_angle(q16_16(0.0));
+    axis.drive_servo();
+    TEST_ASSERT_EQUAL_INT((SERVO_MIN_PULSE_WIDTH + SERVO_MAX_PULSE_WIDTH) / 2, host_servo_pulse_us(TEST_SERVO_PIN_FIXED));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_add_sub_saturate);
+    RUN_TEST(test_mul_div_saturate);
+    RUN_TEST(test_q1_31_range);
+    RUN_TEST(test_from_double_rounds_to_nearest);
+    RUN_TEST(test_mul_rounds_to_nearest);
+    RUN_TEST(test_to_int_truncates_toward_zero);
+    RUN_TEST(test_rescale_between_formats);
+    RUN_TEST(test_from_float_matches_from_double);
+    RUN_TEST(test_from_float_special_values);
+    RUN_TEST(test_servo_fixed_matches_float);
+    RUN_TEST(test_servo_zero_is_center);
+    return UNITY_END();
+}
@@ -0,0 +1,84 @@
+// Host tests for datalog/telemetry_mux.h scheduling.
+//     pio test -e native_test -f test_telemetry_mux
+
+#include <unity.h>
+#include <string.h>
+#include "datalog/telemetry_mux.h"
+
+#define TEST_CHANNEL 1
+#define TEST_STEP_US 1000 // build_frame called every 1 ms
+
+void setUp() {}
+void tearDown() {}
+
+static void fill_zeros(uint8_t *buf, void *ctx) {
+    memset(buf, 0, (size_t)ctx);
+}
+
+// frames sent over `duration_us` by a 50 Hz channel whose first build_frame is at start_us
+static uint32_t frames_sent_from(uint32_t start_us, uint32_t duration_us) {
+    Telemetry_Mux mux(1000000); // full airtime, so only the schedule limits the rate
+    mux.add_channel(TEST_CHANNEL, 8, 0, 50, fill_zeros, (void *)8);
+
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    for (uint32_t t = 0; t <= duration_us; t += TEST_STEP_US) {
+        if (mux.build_frame(start_us + t, frame)) mux.report_result(true, 0);
+    }
+    return mux.get_channel(TEST_CHANNEL)->sent_count;
+}
+
+void test_rate_at_boot() {
+    TEST_ASSERT_EQUAL_UINT32(51, frames_sent_from(1000, 1000000));
+}
+
+// first frame after ~36 min of uptime, micros() is past 2^31
+void test_rate_after_half_wrap() {
+    TEST_ASSERT_EQUAL_UINT32(51, frames_sent_from(2200000000u, 1000000));
+    TEST_ASSERT_EQUAL_UINT32(51, frames_sent_from(0x80000000u, 1000000));
+}
+
+// micros() wraps through 0 during the run
+void test_rate_across_wrap() {
+    TEST_ASSERT_EQUAL_UINT32(51, frames_sent_from(0xFFFFFFFFu - 500000, 1000000));
+}
+
+// a rate 0 channel enabled long after start must not wait for a micros() wrap
+void test_enable_after_half_wrap() {
+    Telemetry_Mux mux(1000000);
+    TEST_ASSERT_TRUE(mux.add_channel(TEST_CHANNEL, 8, 0, 50, fill_zeros, (void *)8));
+    TEST_ASSERT_TRUE(mux.add_channel(TEST_CHANNEL + 1, 4, 1, 0, fill_zeros, (void *)4));
+
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    uint32_t t = 1000;
+    mux.build_frame(t, frame);
+    for (int i = 0; i < 40; i++) {
+        t += 60000000; // 40 min in 1 min steps
+        mux.build_frame(t, frame);
+    }
+    mux.set_rate(TEST_CHANNEL + 1, 10);
+    for (uint32_t end = t + 1000000; t != end; t += TEST_STEP_US) mux.build_frame(t, frame);
+    TEST_ASSERT_EQUAL_UINT32(10, mux.get_channel(TEST_CHANNEL + 1)->sent_count);
+}
+
+// a channel added after the first frame starts right away
+void test_add_channel_after_start() {
+    Telemetry_Mux mux(1000000);
+    TEST_ASSERT_TRUE(mux.add_channel(TEST_CHANNEL, 8, 0, 50, fill_zeros, (void *)8));
+
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    uint32_t t = 2200000000u;
+    mux.build_frame(t, frame);
+    TEST_ASSERT_TRUE(mux.add_channel(TEST_CHANNEL + 1, 4, 1, 10, fill_zeros, (void *)4));
+    for (uint32_t i = 1; i < 1000; i++) mux.build_frame(t + i * TEST_STEP_US, frame);
+    TEST_ASSERT_EQUAL_UINT32(10, mux.get_channel(TEST_CHANNEL + 1)->sent_count);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rate_at_boot);
+    RUN_TEST(test_rate_after_half_wrap);
+    RUN_TEST(test_rate_across_wrap);
+    RUN_TEST(test_enable_after_half_wrap);
+    RUN_TEST(test_add_channel_after_start);
+    return UNITY_END();
+}
@@ -0,0 +1,228 @@
+// Host tests for sensors/tfmini_parser.h on byte streams with noise, resync and partial frames.
+//     pio test -e native_test -f test_tfmini_parser
+
+#include <unity.h>
+#include <string.h>
+#include "sensors/tfmini_parser.h"
+
+#define TEST_NUM_FRAMES 2000
+#define TEST_STREAM_SIZE (TEST_NUM_FRAMES * (TFMINI_FRAME_SIZE + 16))
+
+static uint8_t stream[TEST_STREAM_SIZE];
+static uint16_t expected[TEST_NUM_FRAMES]; // distances of the intact frames, in stream order
+static TFMini_Frame frames[TEST_NUM_FRAMES + 64];
+
+void setUp() {}
+void tearDown() {}
+
+// deterministic noise, so a failure reproduces
+static uint32_t lcg_state;
+static uint8_t next_random() {
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return (uint8_t)(lcg_state >> 24);
+}
+
+static size_t put_frame(uint8_t *out, uint16_t distance, uint16_t strength, uint16_t temperature) {
+    out[0] = TFMINI_HEADER;
+    out[1] = TFMINI_HEADER;
+    out[2] = distance & 0xFF;
+    out[3] = distance >> 8;
+    out[4] = strength & 0xFF;
+    out[5] = strength >> 8;
+    out[6] = temperature & 0xFF;
+    out[7] = temperature >> 8;
+    uint8_t sum = 0;
+    for (int i = 0; i < TFMINI_FRAME_SIZE - 1; i++) sum += out[i];
+    out[8] = sum;
+    return TFMINI_FRAME_SIZE;
+}
+
+void test_clean_stream() {
+    size_t len = 0;
+    for (int i = 0; i < TEST_NUM_FRAMES; i++) {
+        expected[i] = (uint16_t)(100 + i);
+        len += put_frame(&stream[len], expected[i], (uint16_t)(1000 + i), 2200);
+    }
+
+    TFMini_Frame_Parser parser;
+    size_t n = parser.parse(stream, len, frames, TEST_NUM_FRAMES);
+    TEST_ASSERT_EQUAL_UINT32(TEST_NUM_FRAMES, n);
+    for (int i = 0; i < TEST_NUM_FRAMES; i++) {
+        TEST_ASSERT_EQUAL_UINT16(expected[i], frames[i].distance_cm);
+        TEST_ASSERT_EQUAL_UINT16(1000 + i, frames[i].strength);
+        TEST_ASSERT_EQUAL_UINT16(2200, frames[i].temperature_raw);
+        TEST_ASSERT_EQUAL_UINT16((i + 1) * TFMINI_FRAME_SIZE, frames[i].end_offset);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, parser.get_stats().checksum_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.get_stats().bytes_discarded);
+}
+
+// noise bursts between frames with header bytes sprinkled in, but never two in
+// a row and never right before a frame, so no false frame can form
+void test_noise_bursts() {
+    lcg_state = 1;
+    size_t len = 0;
+    for (int i = 0; i < TEST_NUM_FRAMES; i++) {
+        int burst = next_random() % 16;
+        for (int k = 0; k < burst; k++) {
+            uint8_t b = next_random();
+            bool header = (b & 3) == 0 && k + 1 < burst && (len == 0 || stream[len - 1] != TFMINI_HEADER);
+            stream[len++] = header ? TFMINI_HEADER : (b == TFMINI_HEADER ? 0 : b);
+        }
+        expected[i] = (uint16_t)(i * 7);
+        len += put_frame(&stream[len], expected[i], 500, 2200);
+    }
+
+    TFMini_Frame_Parser parser;
+    size_t n = parser.parse(stream, len, frames, sizeof(frames) / sizeof(frames[0]));
+    TEST_ASSERT_EQUAL_UINT32(TEST_NUM_FRAMES, n);
+    for (int i = 0; i < TEST_NUM_FRAMES; i++) TEST_ASSERT_EQUAL_UINT16(expected[i], frames[i].distance_cm);
+    TEST_ASSERT_GREATER_THAN(0, parser.get_stats().bytes_discarded);
+}
+
+// Heavy on header bytes, so false 0x59 0x59 headers keep forming and the parser
+// has to resync out of them. Not every frame can survive: a false header up to
+// 8 bytes before a real one passes its checksum 1 time in 256 and takes the
+// real header with it. That is a property of the protocol, not the parser.
+void test_noise_with_false_headers() {
+    static int16_t index_of[65536];
+    memset(index_of, 0xFF, sizeof(index_of));
+    lcg_state = 3;
+    size_t len = 0;
+    for (int i = 0; i < TEST_NUM_FRAMES; i++) {
+        int burst = next_random() % 16;
+        for (int k = 0; k < burst; k++) {
+            uint8_t b = next_random();
+            stream[len++] = (b & 3) == 0 ? TFMINI_HEADER : b;
+        }
+        expected[i] = (uint16_t)(i * 7);
+        index_of[expected[i]] = (int16_t)i;
+        len += put_frame(&stream[len], expected[i], 500, 2200);
+    }
+
+    TFMini_Frame_Parser parser;
+    size_t n = parser.parse(stream, len, frames, sizeof(frames) / sizeof(frames[0]));
+    // real frames come out in order, false ones may sit in between
+    int last = -1;
+    size_t recovered = 0;
+    for (size_t i = 0; i < n; i++) {
+        int idx = index_of[frames[i].distance_cm];
+        if (idx > last && frames[i].strength == 500) {
+            last = idx;
+            recovered++;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(TEST_NUM_FRAMES * 99 / 100, recovered);
+    TEST_ASSERT_GREATER_THAN(0, parser.get_stats().checksum_errors);
+}
+
+// a bad frame whose rejected bytes hide the header of a good one
+void test_resync_inside_bad_frame() {
+    uint8_t data[64];
+    size_t len = 0;
+    // truncated frame: header + 2 bytes, then a full frame starts inside its 9-byte window
+    data[len++] = TFMINI_HEADER;
+    data[len++] = TFMINI_HEADER;
+    data[len++] = 0x12;
+    data[len++] = 0x34;
+    len += put_frame(&data[len], 321, 10, 2200);
+    // corrupted frame with 0x59 0x59 in its payload, a good frame right after
+    size_t bad = len;
+    len += put_frame(&data[len], 0x5959, 0x5959, 2200);
+    data[bad + 8] ^= 0xFF;
+    len += put_frame(&data[len], 654, 20, 2200);
+
+    TFMini_Frame_Parser parser;
+    TFMini_Frame out[4];
+    size_t n = parser.parse(data, len, out, 4);
+    TEST_ASSERT_EQUAL_UINT32(2, n);
+    TEST_ASSERT_EQUAL_UINT16(321, out[0].distance_cm);
+    TEST_ASSERT_EQUAL_UINT16(4 + TFMINI_FRAME_SIZE, out[0].end_offset);
+    TEST_ASSERT_EQUAL_UINT16(654, out[1].distance_cm);
+    TEST_ASSERT_EQUAL_UINT16(len, out[1].end_offset);
+    TEST_ASSERT_GREATER_THAN(0, parser.get_stats().checksum_errors);
+}
+
+// the same noisy stream in arbitrary chunks gives exactly the same frames and
+// discards as parsing it whole: partial frames and resync state carry over
+void test_arbitrary_chunk_splits() {
+    lcg_state = 7;
+    size_t len = 0;
+    for (int i = 0; i < 200; i++) {
+        int burst = next_random() % 5;
+        for (int k = 0; k < burst; k++) {
+            uint8_t b = next_random();
+            stream[len++] = (b & 3) == 0 ? TFMINI_HEADER : b;
+        }
+        len += put_frame(&stream[len], (uint16_t)(1000 + i), 500, 2200);
+    }
+
+    TFMini_Frame_Parser whole;
+    size_t n_whole = whole.parse(stream, len, frames, sizeof(frames) / sizeof(frames[0]));
+    TEST_ASSERT_GREATER_THAN(195, n_whole);
+
+    static TFMini_Frame chunked[256];
+    // fixed chunk sizes (1 is byte at a time), then random ones up to a UART drain
+    for (int run = 0; run < 80; run++) {
+        lcg_state = (uint32_t)run;
+        TFMini_Frame_Parser parser;
+        size_t n = 0;
+        for (size_t pos = 0; pos < len;) {
+            size_t chunk = run < 20 ? (size_t)run + 1 : 1 + next_random() % 64;
+            if (chunk > len - pos) chunk = len - pos;
+            TFMini_Frame out[16];
+            size_t got = parser.parse(&stream[pos], chunk, out, 16);
+            for (size_t k = 0; k < got; k++) {
+                chunked[n] = out[k];
+                chunked[n].end_offset = (uint16_t)(pos + out[k].end_offset); // back to stream offsets
+                n++;
+            }
+            pos += chunk;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32(n_whole, n);
+        for (size_t i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT16(frames[i].distance_cm, chunked[i].distance_cm);
+            TEST_ASSERT_EQUAL_UINT16(frames[i].end_offset, chunked[i].end_offset);
+        }
+        TEST_ASSERT_EQUAL_UINT32(whole.get_stats().bytes_discarded, parser.get_stats().bytes_discarded);
+    }
+}
+
+// a frame cut off at the end of a chunk is held, not reported or dropped
+void test_partial_frame_held() {
+    uint8_t data[TFMINI_FRAME_SIZE];
+    put_frame(data, 777, 1, 2200);
+
+    TFMini_Frame_Parser parser;
+    TFMini_Frame out[2];
+    TEST_ASSERT_EQUAL_UINT32(0, parser.parse(data, 5, out, 2));
+    TEST_ASSERT_EQUAL_UINT32(1, parser.parse(&data[5], TFMINI_FRAME_SIZE - 5, out, 2));
+    TEST_ASSERT_EQUAL_UINT16(777, out[0].distance_cm);
+    TEST_ASSERT_EQUAL_UINT16(TFMINI_FRAME_SIZE - 5, out[0].end_offset);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.get_stats().bytes_discarded);
+}
+
+// frames past max_frames are dropped from the output but still counted
+void test_max_frames() {
+    size_t len = 0;
+    for (int i = 0; i < 5; i++) len += put_frame(&stream[len], (uint16_t)i, 1, 2200);
+
+    TFMini_Frame_Parser parser;
+    TFMini_Frame out[3];
+    TEST_ASSERT_EQUAL_UINT32(3, parser.parse(stream, len, out, 3));
+    TEST_ASSERT_EQUAL_UINT16(2, out[2].distance_cm);
+    TEST_ASSERT_EQUAL_UINT32(5, parser.get_stats().frames);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_stream);
+    RUN_TEST(test_noise_bursts);
+    RUN_TEST(test_noise_with_false_headers);
+    RUN_TEST(test_resync_inside_bad_frame);
+    RUN_TEST(test_arbitrary_chunk_splits);
+    RUN_TEST(test_partial_frame_held);
+    RUN_TEST(test_max_frames);
+    return UNITY_END();
+}
@@ -0,0 +1,13 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal stand-in for the Teensy core so the pure-compute parts of src/
+// (servo mapping, fixed point, parsers, telemetry packing) build on the host.
+// Only add what those files actually use.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef HOST_SERVO_H
+#define HOST_SERVO_H
+
+#include <stdint.h>
+
+// Host stand-in for the Teensy Servo library. The last pulse width written to
+// each pin is recorded (per thread, so parallel simulations don't interfere)
+// and a plant model reads it back with host_servo_pulse_us().
+
+#define HOST_SERVO_MAX_PINS 64
+
+inline thread_local int host_servo_pulses[HOST_SERVO_MAX_PINS];
+
+inline int host_servo_pulse_us(int pin) {
+    return (pin >= 0 && pin < HOST_SERVO_MAX_PINS) ? host_servo_pulses[pin] : 0;
+}
+
+class Servo {
+public:
+    uint8_t attach(int pin) {
+        this->pin = pin;
+        return 1;
+    }
+
+    void writeMicroseconds(int us) {
+        if (pin >= 0 && pin < HOST_SERVO_MAX_PINS) host_servo_pulses[pin] = us;
+    }
+
+private:
+    int pin = -1;
+};
+
+#endif
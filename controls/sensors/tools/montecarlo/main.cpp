@@ -0,0 +1,157 @@
+/*
+Monte Carlo dispersion runner for gimbal control tuning.
+
+Builds the flight Gimbal / Servo_Axis code (src/motors/servo_drivers.cpp,
+limits from src/config.h) for the host and flies thousands of randomized
+vehicles (thrust misalignment, servo lag, sensor noise, CG offset, ...) for
+every point of a PD gain sweep, spread over all cores with a work-stealing
+thread pool. Prints one CSV row of statistics per gain pair.
+
+    pio run -e montecarlo -t exec -a "--cases 2000 --kp 0.2:2.0:10 --kd 0.02:0.3:8"
+
+Options:
+    --cases N        cases per gain pair (default 1000)
+    --threads N      worker threads (default: all hardware threads)
+    --seed N         base seed; the same seed gives the same results on any thread count
+    --kp lo:hi:n     proportional gain sweep (default 0.5:1.5:5)
+    --kd lo:hi:n     derivative gain sweep (default 0.05:0.2:4)
+    --fixed          run the drivers in Q16.16 (what the teensy31 flies)
+*/
+
+#include "plant.h"
+#include "thread_pool.h"
+#include "config.h"
+#include "math/fixed_point.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define CASES_PER_TASK 64 // small enough to balance, large enough to amortize the queue
+
+struct Sweep {
+    double lo, hi;
+    int count;
+
+    double at(int i) const { return count > 1 ? lo + (hi - lo) * i / (count - 1) : lo; }
+};
+
+struct Options {
+    int cases = 1000;
+    unsigned threads = 0;
+    uint64_t seed = 1;
+    Sweep kp = {0.5, 1.5, 5};
+    Sweep kd = {0.05, 0.2, 4};
+    bool fixed = false;
+};
+
+static bool parse_sweep(const char *text, Sweep& sweep) {
+    return sscanf(text, "%lf:%lf:%d", &sweep.lo, &sweep.hi, &sweep.count) == 3 && sweep.count > 0;
+}
+
+static bool parse_options(int argc, char **argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(arg, "--fixed")) { opt.fixed = true; continue; }
+        if (!value) return false;
+        i++;
+        if (!strcmp(arg, "--cases")) opt.cases = atoi(value);
+        else if (!strcmp(arg, "--threads")) opt.threads = (unsigned)atoi(value);
+        else if (!strcmp(arg, "--seed")) opt.seed = strtoull(value, nullptr, 0);
+        else if (!strcmp(arg, "--kp")) { if (!parse_sweep(value, opt.kp)) return false; }
+        else if (!strcmp(arg, "--kd")) { if (!parse_sweep(value, opt.kd)) return false; }
+        else return false;
+    }
+    return opt.cases > 0;
+}
+
+// nearest-rank percentile, sorts in place
+static double percentile(std::vector<double>& values, double p) {
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)std::ceil(p / 100.0 * values.size());
+    return values[rank ? rank - 1 : 0];
+}
+
+static double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+static void print_row(const Gains& gains, const Case_Result *results, int count) {
+    std::vector<double> tilt, saturated, settling;
+    int unsettled = 0;
+    for (int i = 0; i < count; i++) {
+        tilt.push_back(results[i].max_tilt_rads * RAD_TO_DEG);
+        saturated.push_back(results[i].saturated_s);
+        settling.push_back(results[i].settling_s);
+        if (!results[i].settled) unsettled++;
+    }
+    double tilt_mean = mean(tilt), sat_mean = mean(saturated), settle_mean = mean(settling);
+    printf("%.4f,%.4f,%d,%.3f,%.3f,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+           gains.kp, gains.kd, count,
+           tilt_mean, percentile(tilt, 95), percentile(tilt, 100),
+           sat_mean, percentile(saturated, 95),
+           settle_mean, percentile(settling, 95),
+           (double)unsettled / count);
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        fprintf(stderr, "usage: montecarlo [--cases N] [--threads N] [--seed N] "
+                        "[--kp lo:hi:n] [--kd lo:hi:n] [--fixed]\n");
+        return 1;
+    }
+
+    Sim_Config config;
+    std::vector<Gains> sweep;
+    for (int i = 0; i < opt.kp.count; i++) {
+        for (int j = 0; j < opt.kd.count; j++) {
+            sweep.push_back({opt.kp.at(i), opt.kd.at(j)});
+        }
+    }
+
+    // every gain pair flies the same set of vehicles
+    std::vector<Dispersion> dispersions(opt.cases);
+    for (int i = 0; i < opt.cases; i++) {
+        dispersions[i] = Dispersion::draw(config, opt.seed, (uint64_t)i);
+    }
+
+    // results are written by index, so workers never share anything but the queues
+    std::vector<Case_Result> results(sweep.size() * opt.cases);
+    Work_Stealing_Pool pool(opt.threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t g = 0; g < sweep.size(); g++) {
+        for (int first = 0; first < opt.cases; first += CASES_PER_TASK) {
+            int last = std::min(first + CASES_PER_TASK, opt.cases);
+            pool.submit([&, g, first, last] {
+                for (int i = first; i < last; i++) {
+                    results[g * opt.cases + i] = opt.fixed
+                        ? run_case<q16_16>(config, sweep[g], dispersions[i])
+                        : run_case<float>(config, sweep[g], dispersions[i]);
+                }
+            });
+        }
+    }
+    pool.wait();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("kp,kd,cases,max_tilt_mean_deg,max_tilt_p95_deg,max_tilt_max_deg,"
+           "saturated_mean_s,saturated_p95_s,settling_mean_s,settling_p95_s,unsettled_frac\n");
+    for (size_t g = 0; g < sweep.size(); g++) {
+        print_row(sweep[g], &results[g * opt.cases], opt.cases);
+    }
+
+    size_t total = results.size();
+    fprintf(stderr, "%zu cases (%s) on %u threads in %.2f s, %.0f cases/s, %llu steals\n",
+            total, opt.fixed ? "q16_16" : "float", pool.size(), elapsed, total / elapsed,
+            (unsigned long long)pool.get_steal_count());
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "plant.h"
+#include "config.h"
+#include "motors/servo_drivers.h"
+#include <Servo.h>
+#include <cmath>
+
+// splitmix64: tiny, fast and identical on every platform, unlike std:: distributions
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); } // [0, 1)
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+
+    // Box-Muller
+    double normal(double sigma) {
+        double u1 = uniform();
+        double u2 = uniform();
+        if (u1 < 1e-300) u1 = 1e-300;
+        return sigma * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+    }
+
+private:
+    uint64_t state;
+};
+
+Dispersion Dispersion::draw(const Sim_Config& c, uint64_t seed, uint64_t case_index) {
+    Random rng(seed ^ (case_index * 0xD1B54A32D192ED03ULL));
+    Dispersion d;
+    for (int axis = 0; axis < 2; axis++) {
+        d.misalign_rads[axis] = rng.normal(c.thrust_misalign_sigma_rads);
+        d.cg_lateral_m[axis] = rng.normal(c.cg_lateral_sigma_m);
+        d.gyro_bias_rads[axis] = rng.normal(c.gyro_bias_sigma_rads);
+        d.initial_tilt_rads[axis] = rng.normal(c.initial_tilt_sigma_rads);
+        d.initial_rate_rads[axis] = rng.normal(c.initial_rate_sigma_rads);
+    }
+    d.thrust_scale = 1.0 + rng.normal(c.thrust_scale_sigma);
+    d.cg_axial_m = rng.normal(c.cg_axial_sigma_m);
+    d.inertia_scale = 1.0 + rng.normal(c.inertia_scale_sigma);
+    d.servo_lag_s = rng.uniform(c.servo_lag_min_s, c.servo_lag_max_s);
+    d.noise_seed = rng.next();
+    return d;
+}
+
+// Pitch and yaw are simulated as two decoupled single-axis rigid bodies
+// (small angles, no roll coupling), each driven by one gimbal servo:
+//     I * tilt'' = -F * L * sin(gimbal + misalignment) + F * cg_lateral_offset
+// The controller is a PD law on measured tilt and rate. Its output goes
+// through Gimbal::drive_servos, and the pulse widths the driver writes are
+// turned back into servo angles through a lagged, rate-limited servo model.
+template <typename Real>
+Case_Result run_case(const Sim_Config& c, const Gains& gains, const Dispersion& d) {
+    const int pins[2] = {SERVO_PIN_Y, SERVO_PIN_Z};
+    Gimbal_T<Real> gimbal(SERVO_PIN_Y, SERVO_PIN_Z);
+    gimbal.setup();
+
+    // physical servo: centered pulse is neutral, same scale the drivers assume
+    const double center_us = (SERVO_MIN_PULSE_WIDTH + SERVO_MAX_PULSE_WIDTH) / 2.0;
+    const double rads_per_us = SERVO_RANGE_RADS / (SERVO_MAX_PULSE_WIDTH - SERVO_MIN_PULSE_WIDTH);
+    const double servo_offsets[2] = {SERVO_OFFSET_Y, SERVO_OFFSET_Z};
+
+    const double thrust = c.thrust_n * d.thrust_scale;
+    const double arm = c.gimbal_to_cg_m + d.cg_axial_m;
+    const double inertia = c.inertia_kgm2 * d.inertia_scale;
+    const double max_servo_step = c.servo_speed_rads * c.sim_dt_s;
+
+    double tilt[2], rate[2], servo_angle[2], servo_target[2];
+    for (int axis = 0; axis < 2; axis++) {
+        tilt[axis] = d.initial_tilt_rads[axis];
+        rate[axis] = d.initial_rate_rads[axis];
+        servo_angle[axis] = servo_target[axis] = servo_offsets[axis];
+    }
+
+    Random noise(d.noise_seed);
+    Case_Result result = {0.0, 0.0, 0.0, true};
+    bool saturated = false;
+
+    const int steps = (int)std::lround(c.burn_time_s / c.sim_dt_s);
+    const int control_every = (int)std::lround(c.control_dt_s / c.sim_dt_s);
+    for (int step = 0; step < steps; step++) {
+        double t = step * c.sim_dt_s;
+
+        if (step % control_every == 0) {
+            double cmd[2];
+            saturated = false;
+            for (int axis = 0; axis < 2; axis++) {
+                double tilt_meas = tilt[axis] + noise.normal(c.angle_noise_sigma_rads);
+                double rate_meas = rate[axis] + d.gyro_bias_rads[axis] + noise.normal(c.gyro_noise_sigma_rads);
+                cmd[axis] = gains.kp * tilt_meas + gains.kd * rate_meas;
+                if (std::fabs(cmd[axis]) > c.gimbal_limit_rads) {
+                    cmd[axis] = std::copysign(c.gimbal_limit_rads, cmd[axis]);
+                    saturated = true;
+                }
+            }
+
+            // same float-to-Real conversion the firmware uses for sensor-derived commands
+            gimbal.drive_servos(num::from_float<Real>(float(cmd[0])), num::from_float<Real>(float(cmd[1])));
+
+            for (int axis = 0; axis < 2; axis++) {
+                int pulse = host_servo_pulse_us(pins[axis]);
+                // pulse pinned at the end of the range means Servo_Axis clipped the command
+                if (pulse <= SERVO_MIN_PULSE_WIDTH || pulse >= SERVO_MAX_PULSE_WIDTH) saturated = true;
+                servo_target[axis] = (pulse - center_us) * rads_per_us;
+            }
+        }
+
+        for (int axis = 0; axis < 2; axis++) {
+            double step_rads = (servo_target[axis] - servo_angle[axis]) * c.sim_dt_s / d.servo_lag_s;
+            if (step_rads > max_servo_step) step_rads = max_servo_step;
+            if (step_rads < -max_servo_step) step_rads = -max_servo_step;
+            servo_angle[axis] += step_rads;
+
+            double gimbal_angle = (servo_angle[axis] - servo_offsets[axis]) * GIMBAL_RATIO;
+            double torque = -thrust * arm * std::sin(gimbal_angle + d.misalign_rads[axis])
+                          + thrust * d.cg_lateral_m[axis];
+            rate[axis] += torque / inertia * c.sim_dt_s; // semi-implicit Euler
+            tilt[axis] += rate[axis] * c.sim_dt_s;
+
+            double abs_tilt = std::fabs(tilt[axis]);
+            if (abs_tilt > result.max_tilt_rads) result.max_tilt_rads = abs_tilt;
+            if (abs_tilt > c.settle_band_rads) result.settling_s = t + c.sim_dt_s;
+        }
+        if (saturated) result.saturated_s += c.sim_dt_s;
+    }
+
+    result.settled = result.settling_s < c.burn_time_s;
+    return result;
+}
+
+template Case_Result run_case<float>(const Sim_Config&, const Gains&, const Dispersion&);
+template Case_Result run_case<q16_16>(const Sim_Config&, const Gains&, const Dispersion&);
@@ -0,0 +1,66 @@
+#ifndef PLANT_H
+#define PLANT_H
+
+#include <cstdint>
+
+// Nominal vehicle and simulation settings. Every dispersion is drawn around these.
+struct Sim_Config {
+    double thrust_n = 30.0;          // average motor thrust
+    double burn_time_s = 3.0;
+    double inertia_kgm2 = 0.05;      // pitch/yaw moment of inertia
+    double gimbal_to_cg_m = 0.40;    // moment arm from the gimbal pivot to the CG
+    double gimbal_limit_rads = 0.14; // mechanical gimbal limit (~8 deg), controller clamps to it
+    double servo_speed_rads = 10.5;  // servo slew rate (0.1 s / 60 deg)
+    double sim_dt_s = 0.001;         // plant integration step
+    double control_dt_s = 0.01;      // control loop period (100 Hz)
+    double settle_band_rads = 0.035; // |tilt| below ~2 deg counts as settled
+
+    // 1-sigma dispersions (servo lag is uniform between the two bounds)
+    double thrust_misalign_sigma_rads = 0.0087; // 0.5 deg
+    double thrust_scale_sigma = 0.05;
+    double cg_axial_sigma_m = 0.02;
+    double cg_lateral_sigma_m = 0.002;
+    double inertia_scale_sigma = 0.05;
+    double servo_lag_min_s = 0.01;
+    double servo_lag_max_s = 0.04;
+    double angle_noise_sigma_rads = 0.0035;     // 0.2 deg
+    double gyro_noise_sigma_rads = 0.005;
+    double gyro_bias_sigma_rads = 0.002;
+    double initial_tilt_sigma_rads = 0.0175;    // 1 deg
+    double initial_rate_sigma_rads = 0.035;     // 2 deg/s
+};
+
+struct Gains {
+    double kp; // rad of gimbal per rad of tilt
+    double kd; // rad of gimbal per rad/s of tilt rate
+};
+
+// One randomized vehicle, drawn deterministically from (seed, case index) so
+// results don't depend on which thread ran the case.
+struct Dispersion {
+    double misalign_rads[2];
+    double cg_lateral_m[2];
+    double thrust_scale;
+    double cg_axial_m;
+    double inertia_scale;
+    double servo_lag_s;
+    double gyro_bias_rads[2];
+    double initial_tilt_rads[2];
+    double initial_rate_rads[2];
+    uint64_t noise_seed;
+
+    static Dispersion draw(const Sim_Config& config, uint64_t seed, uint64_t case_index);
+};
+
+struct Case_Result {
+    double max_tilt_rads;   // worst tilt of either axis over the burn
+    double saturated_s;     // time the gimbal command sat at a limit (controller clamp or servo clip)
+    double settling_s;      // last time |tilt| was outside the settle band
+    bool settled;           // tilt was inside the band at burnout
+};
+
+// Flies one case through the real Gimbal/Servo_Axis code (float or q16_16).
+template <typename Real>
+Case_Result run_case(const Sim_Config& config, const Gains& gains, const Dispersion& d);
+
+#endif
@@ -0,0 +1,86 @@
+#include "thread_pool.h"
+
+Work_Stealing_Pool::Work_Stealing_Pool(unsigned num_threads) {
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 1;
+
+    for (unsigned i = 0; i < num_threads; i++) {
+        queues.emplace_back(new Worker_Queue());
+    }
+    for (unsigned i = 0; i < num_threads; i++) {
+        threads.emplace_back(&Work_Stealing_Pool::worker_loop, this, i);
+    }
+}
+
+Work_Stealing_Pool::~Work_Stealing_Pool() {
+    {
+        std::lock_guard<std::mutex> guard(wake_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void Work_Stealing_Pool::submit(Task task) {
+    unsigned index = next_queue++ % queues.size();
+    pending++;
+    {
+        // counted before the push so `queued` never drops below the real count,
+        // and under wake_lock so a worker can't miss the wakeup
+        std::lock_guard<std::mutex> guard(wake_lock);
+        queued++;
+    }
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void Work_Stealing_Pool::wait() {
+    std::unique_lock<std::mutex> guard(wake_lock);
+    done.wait(guard, [this] { return pending.load() == 0; });
+}
+
+bool Work_Stealing_Pool::pop_local(unsigned index, Task& task) {
+    Worker_Queue& q = *queues[index];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.tasks.empty()) return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool Work_Stealing_Pool::steal(unsigned thief, Task& task) {
+    for (unsigned k = 1; k < queues.size(); k++) {
+        Worker_Queue& q = *queues[(thief + k) % queues.size()];
+        std::unique_lock<std::mutex> guard(q.lock, std::try_to_lock);
+        if (!guard.owns_lock() || q.tasks.empty()) continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        steals++;
+        return true;
+    }
+    return false;
+}
+
+void Work_Stealing_Pool::worker_loop(unsigned index) {
+    Task task;
+    while (true) {
+        if (pop_local(index, task) || steal(index, task)) {
+            queued--;
+            task();
+            task = nullptr;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> guard(wake_lock);
+                done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(wake_lock);
+        // a steal may have skipped a busy queue, so only sleep once nothing is queued at all
+        wake.wait(guard, [this] { return stopping.load() || queued.load() > 0; });
+        if (stopping && queued.load() == 0) return;
+    }
+}
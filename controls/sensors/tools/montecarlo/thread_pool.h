@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker has its own deque: it takes its own
+// work from the back (most recently submitted, still warm in cache) and, when
+// that runs dry, steals from the front of the other workers' deques. Workers
+// only contend on a lock while stealing, so throughput scales with core count.
+class Work_Stealing_Pool {
+public:
+    using Task = std::function<void()>;
+
+    explicit Work_Stealing_Pool(unsigned num_threads = 0); // 0 = one per hardware thread
+    ~Work_Stealing_Pool();
+
+    Work_Stealing_Pool(const Work_Stealing_Pool&) = delete;
+    Work_Stealing_Pool& operator=(const Work_Stealing_Pool&) = delete;
+
+    // Tasks are dealt round-robin onto the workers' deques.
+    void submit(Task task);
+    // Blocks until every submitted task has finished.
+    void wait();
+
+    unsigned size() const { return (unsigned)threads.size(); }
+    uint64_t get_steal_count() const { return steals.load(); }
+
+private:
+    struct Worker_Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(unsigned index);
+    bool pop_local(unsigned index, Task& task);
+    bool steal(unsigned thief, Task& task);
+
+    std::vector<std::unique_ptr<Worker_Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::atomic<size_t> queued{0};   // tasks sitting in a deque
+    std::atomic<size_t> pending{0};  // tasks submitted but not finished
+    std::atomic<unsigned> next_queue{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<bool> stopping{false};
+
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+};
+
+#endif